@@ -0,0 +1,268 @@
+#pragma once
+#include <vector>
+#include <unordered_map>
+#include <string>
+#include <algorithm>
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <stdexcept>
+using namespace std;
+
+
+// Shared by Currency1.cpp and Currency2.cpp.
+
+
+/*
+-------------------------------------------------------
+CURRENCY GRAPH (interned ids + CSR adjacency)
+-------------------------------------------------------
+Currency codes are interned to dense ids 0..V-1 once.
+Edges of node u live in [offsets[u], offsets[u+1]) of
+the flat targets / weights arrays, so a traversal only
+touches contiguous memory and never hashes a string.
+Build: O(V + E)   Space: O(V + E)
+*/
+struct CurrencyGraph {
+   unordered_map<string, int> ids;                      // currency code -> dense id
+   vector<string> names;                                // dense id -> currency code
+   vector<int> offsets;                                 // size V + 1
+   vector<int> targets;                                 // size 2E (both directions)
+   vector<double> weights;                              // rate along targets[e]
+   vector<double> inRates;                              // rate of the mirrored in-edge targets[e] -> u
+
+   int size() const { return (int)names.size(); }
+
+   int idOf(const string& currency) const {
+       auto it = ids.find(currency);
+       return it == ids.end() ? -1 : it->second;
+   }
+
+   int intern(const string& currency) {
+       auto it = ids.find(currency);
+       if (it != ids.end()) return it->second;
+       int id = (int)names.size();
+       ids.emplace(currency, id);
+       names.push_back(currency);
+       return id;
+   }
+
+   vector<int> edgeSrc, edgeDst;                        // parsed edge list (CSR source of truth)
+   vector<double> edgeRate;
+   vector<int> forwardSlot, backwardSlot;               // CSR entries of edge i: src -> dst, dst -> src
+   unordered_multimap<long long, int> edgesBetween;     // unordered pair -> edge list indices
+   bool dirty = false;                                  // edges appended since last finalize()
+
+   static long long pairKey(int u, int v) {
+       return ((long long)min(u, v) << 32) | (unsigned)max(u, v);
+   }
+
+   void build(const vector<vector<string>>& rates) {
+       ids.clear(); names.clear();
+       edgeSrc.clear(); edgeDst.clear(); edgeRate.clear();
+       edgeSrc.reserve(rates.size()); edgeDst.reserve(rates.size()); edgeRate.reserve(rates.size());
+       for (auto& rate : rates) addEdge(intern(rate[0]), intern(rate[1]), stod(rate[2]));
+       finalize();
+   }
+
+   void addEdge(int src, int dst, double value) {
+       edgeSrc.push_back(src); edgeDst.push_back(dst); edgeRate.push_back(value);
+       dirty = true;
+   }
+
+   // Counting sort of edges by source → CSR
+   void finalize() {
+       int n = size();
+       offsets.assign(n + 1, 0);
+       for (size_t i = 0; i < edgeSrc.size(); i++) {
+           offsets[edgeSrc[i] + 1]++;
+           offsets[edgeDst[i] + 1]++;
+       }
+       for (int u = 0; u < n; u++) offsets[u + 1] += offsets[u];
+       targets.assign(offsets[n], 0);
+       weights.assign(offsets[n], 0.0);
+       inRates.assign(offsets[n], 0.0);
+       vector<int> cursor(offsets.begin(), offsets.end() - 1);
+       forwardSlot.resize(edgeSrc.size());
+       backwardSlot.resize(edgeSrc.size());
+       edgesBetween.clear();
+       edgesBetween.reserve(edgeSrc.size());
+       for (size_t i = 0; i < edgeSrc.size(); i++) {
+           int e = forwardSlot[i] = cursor[edgeSrc[i]]++;
+           targets[e] = edgeDst[i]; weights[e] = edgeRate[i]; inRates[e] = 1.0 / edgeRate[i];
+           e = backwardSlot[i] = cursor[edgeDst[i]]++;
+           targets[e] = edgeSrc[i]; weights[e] = 1.0 / edgeRate[i]; inRates[e] = edgeRate[i];
+           edgesBetween.emplace(pairKey(edgeSrc[i], edgeDst[i]), (int)i);
+       }
+       dirty = false;
+   }
+
+   /*
+   Overwrite rate(u -> v) = value (and v -> u = 1 / value)
+   in place. Returns false if the pair has no edge yet; the
+   caller then addEdge() + finalize(). CSR entries whose
+   weight changed are appended to `changed` if given.
+   Time: O(edges between u and v) expected
+   */
+   bool setRate(int u, int v, double value, vector<int>* changed = nullptr) {
+       auto [first, last] = edgesBetween.equal_range(pairKey(u, v));
+       if (first == last) return false;
+       for (auto it = first; it != last; ++it) {
+           int i = it->second;
+           double rate = edgeSrc[i] == u ? value : 1.0 / value;   // as stored: edgeSrc[i] -> edgeDst[i]
+           edgeRate[i] = rate;
+           weights[forwardSlot[i]] = rate; inRates[forwardSlot[i]] = 1.0 / rate;
+           weights[backwardSlot[i]] = 1.0 / rate; inRates[backwardSlot[i]] = rate;
+           if (changed) { changed->push_back(forwardSlot[i]); changed->push_back(backwardSlot[i]); }
+       }
+       return true;
+   }
+};
+
+
+/*
+-------------------------------------------------------
+PARALLEL FOR
+-------------------------------------------------------
+Runs body(i) for i in [0, count) on up to `threads`
+workers; indices are handed out through an atomic
+counter so uneven work balances itself.
+*/
+inline void parallelFor(int count, int threads, const function<void(int)>& body) {
+   threads = max(1, min(threads, count));
+   if (threads == 1) {
+       for (int i = 0; i < count; i++) body(i);
+       return;
+   }
+   atomic<int> next{0};
+   vector<thread> workers;
+   for (int t = 0; t < threads; t++) {
+       workers.emplace_back([&]() {
+           for (int i = next++; i < count; i = next++) body(i);
+       });
+   }
+   for (auto& w : workers) w.join();
+}
+
+
+/*
+-------------------------------------------------------
+RATE STORE (single writer, lock-free snapshot readers)
+-------------------------------------------------------
+The writer applies feed updates to a private draft and
+publish() swaps in an immutable CSR snapshot with one
+atomic exchange. Readers announce the epoch they entered
+in their own cache-line slot, load the current pointer,
+search it, and go idle again: no locks, no waiting.
+A replaced snapshot is freed by the writer only once no
+slot still shows an epoch at or before its retirement,
+so reclamation never blocks a reader.
+Query is the reader callback: it owns its search scratch
+and answers query(graph, fromId, toId), -1 if unreachable.
+Reader query: that of Query   publish: O(V + E)
+Batch feed updates between publishes.
+*/
+template <typename Query>
+class RateStore {
+private:
+   static constexpr int MAX_READERS = 64;
+   static constexpr unsigned long long IDLE = ~0ULL;
+
+   struct alignas(64) ReaderSlot {
+       atomic<unsigned long long> epoch{IDLE};          // epoch announced while reading
+       atomic<bool> claimed{false};
+   };
+
+   atomic<const CurrencyGraph*> current{nullptr};
+   atomic<unsigned long long> globalEpoch{1};
+   ReaderSlot slots[MAX_READERS];
+
+   // Writer-only state
+   CurrencyGraph draft;
+   unordered_map<long long, int> edgeIndex;             // (min id, max id) -> index in draft edge list
+   vector<pair<const CurrencyGraph*, unsigned long long>> retired;
+
+   static long long pairKey(int u, int v) {
+       return ((long long)min(u, v) << 32) | (unsigned)max(u, v);
+   }
+
+   void reclaim() {
+       unsigned long long oldestActive = IDLE;
+       for (auto& slot : slots) oldestActive = min(oldestActive, slot.epoch.load());
+       size_t kept = 0;
+       for (auto& [snapshot, retiredAt] : retired) {
+           if (retiredAt < oldestActive) delete snapshot;
+           else retired[kept++] = {snapshot, retiredAt};
+       }
+       retired.resize(kept);
+   }
+
+public:
+   // Per-thread read handle; owns one epoch slot and its own search scratch
+   class Reader {
+   private:
+       RateStore* store;
+       int slot;
+       Query query;
+       friend class RateStore;
+       Reader(RateStore* s, int i) : store(s), slot(i) {}
+   public:
+       Reader(Reader&& other) noexcept : store(other.store), slot(other.slot), query(move(other.query)) {
+           other.store = nullptr;
+       }
+       Reader(const Reader&) = delete;
+       ~Reader() { if (store) store->slots[slot].claimed.store(false); }
+
+       double getConversionRate(const string& from, const string& to) {
+           auto& announced = store->slots[slot].epoch;
+           announced.store(store->globalEpoch.load());
+           const CurrencyGraph* g = store->current.load();
+           double result = g ? query(*g, g->idOf(from), g->idOf(to)) : -1.0;
+           announced.store(IDLE);
+           return result;
+       }
+   };
+
+   RateStore() = default;
+   RateStore(const RateStore&) = delete;
+   ~RateStore() {
+       delete current.load();
+       for (auto& r : retired) delete r.first;
+   }
+
+   // Claim a reader slot; throws if all MAX_READERS slots are taken
+   Reader registerReader() {
+       for (int i = 0; i < MAX_READERS; i++) {
+           bool expected = false;
+           if (slots[i].claimed.compare_exchange_strong(expected, true)) return Reader(this, i);
+       }
+       throw runtime_error("RateStore: too many readers");
+   }
+
+   // Writer: set rate(src -> dst) = value in the private draft (latest value wins)
+   void updateRate(const string& src, const string& dst, double value) {
+       int u = draft.intern(src), v = draft.intern(dst);
+       auto it = edgeIndex.find(pairKey(u, v));
+       if (it == edgeIndex.end()) {
+           edgeIndex[pairKey(u, v)] = (int)draft.edgeSrc.size();
+           draft.addEdge(u, v, value);
+       } else if (draft.edgeSrc[it->second] == u) {
+           draft.edgeRate[it->second] = value;
+       } else {
+           draft.edgeRate[it->second] = 1.0 / value;    // stored the other way round
+       }
+   }
+
+   void loadRates(const vector<vector<string>>& rates) {
+       for (auto& rate : rates) updateRate(rate[0], rate[1], stod(rate[2]));
+   }
+
+   // Writer: make every update so far visible to readers
+   void publish() {
+       auto* snapshot = new CurrencyGraph(draft);
+       snapshot->finalize();
+       const CurrencyGraph* old = current.exchange(snapshot);
+       if (old) retired.push_back({old, globalEpoch.fetch_add(1)});
+       reclaim();
+   }
+};
@@ -3,13 +3,395 @@
 #include <unordered_map>
 #include <queue>
 #include <unordered_set>
+#include <string>
+#include <cmath>
+#include <algorithm>
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <stdexcept>
+#include "Currency.h"
 using namespace std;
 
 
+/*
+-------------------------------------------------------
+SEARCH SCRATCH
+-------------------------------------------------------
+Reusable per-thread buffers. `stamp` marks a node as
+visited in the current query (== epoch), so nothing is
+cleared or allocated between queries.
+*/
+struct SearchScratch {
+   vector<unsigned> stamp;
+   vector<int> queueNodes;
+   vector<double> queueRates;
+   vector<double> rateOf;                               // rate from source, valid where stamp == epoch
+   vector<unsigned> stampBack;                          // backward side of bidirectional search
+   vector<int> queueBack;
+   vector<double> rateBack;                             // rate from target, valid where stampBack == epoch
+   unsigned epoch = 0;
+   int visited = 0;                                     // nodes reached by the last query
+
+   void prepare(int n) {
+       if ((int)stamp.size() < n) { stamp.resize(n, 0); rateOf.resize(n); }
+       if ((int)queueNodes.size() < n) { queueNodes.resize(n); queueRates.resize(n); }
+       visited = 0;
+       nextEpoch();
+   }
+
+   void prepareBackward(int n) {
+       if ((int)stampBack.size() < n) { stampBack.resize(n, 0); rateBack.resize(n); queueBack.resize(n); }
+   }
+
+   void nextEpoch() {
+       if (++epoch == 0) {                              // wrapped: reset stamps once
+           fill(stamp.begin(), stamp.end(), 0);
+           fill(stampBack.begin(), stampBack.end(), 0);
+           epoch = 1;
+       }
+   }
+};
+
+
+/*
+-------------------------------------------------------
+RATE POTENTIAL INDEX (weighted union-find)
+-------------------------------------------------------
+For a consistent rate table every currency has a fixed
+value relative to its component root:
+   toParent[x] = rate(x -> parent[x])
+   rate(a -> b) = rate(a -> root) / rate(b -> root)
+Merges happen online; find() compresses paths.
+addRate: O(α(V))   rate: O(α(V))   Space: O(V)
+*/
+struct RatePotentialIndex {
+   vector<int> parent;
+   vector<int> componentSize;
+   vector<double> toParent;
+   double tolerance = 1e-9;                             // relative slack for consistency checks
+
+   void ensure(int n) {
+       for (int x = (int)parent.size(); x < n; x++) {
+           parent.push_back(x);
+           componentSize.push_back(1);
+           toParent.push_back(1.0);
+       }
+   }
+
+   // Returns root of x and stores rate(x -> root) in rateToRoot
+   int find(int x, double& rateToRoot) {
+       int root = x;
+       rateToRoot = 1.0;
+       while (parent[root] != root) {                   // walk up, accumulating the rate
+           rateToRoot *= toParent[root];
+           root = parent[root];
+       }
+       // Path compression: point every node on the path straight at root
+       double remaining = rateToRoot;                   // rate(x -> root) for the current x
+       while (x != root) {
+           int next = parent[x];
+           double step = toParent[x];
+           parent[x] = root;
+           toParent[x] = remaining;
+           remaining /= step;
+           x = next;
+       }
+       return root;
+   }
+
+   // Record rate(src -> dst) = value.
+   // Returns false if it contradicts the rates already merged (the index is left unchanged).
+   bool addRate(int src, int dst, double value) {
+       ensure(max(src, dst) + 1);
+       double srcToRoot, dstToRoot;
+       int rootSrc = find(src, srcToRoot);
+       int rootDst = find(dst, dstToRoot);
+       if (rootSrc == rootDst) {
+           double implied = srcToRoot / dstToRoot;
+           return abs(implied - value) <= tolerance * max(abs(implied), abs(value));
+       }
+       // rate(rootSrc -> rootDst) = rate(rootSrc -> src) * value * rate(dst -> rootDst)
+       double rootRate = value * dstToRoot / srcToRoot;
+       if (componentSize[rootSrc] < componentSize[rootDst]) {
+           parent[rootSrc] = rootDst;
+           toParent[rootSrc] = rootRate;
+           componentSize[rootDst] += componentSize[rootSrc];
+       } else {
+           parent[rootDst] = rootSrc;
+           toParent[rootDst] = 1.0 / rootRate;
+           componentSize[rootSrc] += componentSize[rootDst];
+       }
+       return true;
+   }
+
+   // rate(from -> to), -1 if not connected
+   double rate(int from, int to) {
+       if (from < 0 || to < 0 || from >= (int)parent.size() || to >= (int)parent.size()) return -1.0;
+       double fromToRoot, toToRoot;
+       if (find(from, fromToRoot) != find(to, toToRoot)) return -1.0;
+       return fromToRoot / toToRoot;
+   }
+};
+
+
+// Search: BFS per query (any path, like the original).
+// Potential: union-find lookup while the table is consistent, BFS otherwise.
+enum class LookupMode { Search, Potential };
+
+
 class CurrencyConverter {
+private:
+   friend struct AnyPathQuery;                          // RateStore reader shares the search routine
+   CurrencyGraph graph;                                 // loaded once, queried many times
+   SearchScratch scratch;
+   RatePotentialIndex potentials;                       // maintained alongside the graph
+   bool consistent = true;                              // false once any rate contradicts another
+   LookupMode mode = LookupMode::Search;
+
+   /*
+   BFS over dense ids on the CSR graph.
+   Time Complexity: O(V + E), no allocation after warm-up
+   */
+   static double bfsRate(const CurrencyGraph& g, int from, int to, SearchScratch& s) {
+       if (from < 0 || to < 0) return -1.0;
+       s.prepare(g.size());
+       int head = 0, tail = 0;
+       s.queueNodes[tail] = from; s.queueRates[tail++] = 1.0;
+       s.stamp[from] = s.epoch;
+       while (head < tail) {
+           int curr = s.queueNodes[head];
+           double currRate = s.queueRates[head++];
+           // Found target
+           if (curr == to) { s.visited = tail; return currRate; }
+           // Explore neighbors
+           for (int e = g.offsets[curr]; e < g.offsets[curr + 1]; e++) {
+               int next = g.targets[e];
+               if (s.stamp[next] != s.epoch) {
+                   s.stamp[next] = s.epoch;
+                   s.queueNodes[tail] = next;
+                   s.queueRates[tail++] = currRate * g.weights[e];
+               }
+           }
+       }
+       // No valid conversion path
+       s.visited = tail;
+       return -1.0;
+   }
+
+   /*
+   Bidirectional BFS: grows whole levels from whichever
+   side has the smaller frontier until the two meet at m.
+   The backward side walks out-edges from `to`; reverse
+   edges are exact inverses, so
+       rate(from -> to) = rate(from -> m) / rate(to -> m)
+   Time: O(V + E) worst case, ~O(b^(d/2)) on expander-like graphs
+   */
+   static double bidirectionalRate(const CurrencyGraph& g, int from, int to, SearchScratch& s) {
+       if (from < 0 || to < 0) return -1.0;
+       s.prepareBackward(g.size());
+       s.prepare(g.size());
+       if (from == to) { s.visited = 1; return 1.0; }
+       int fHead = 0, fTail = 0, bHead = 0, bTail = 0;
+       s.queueNodes[fTail++] = from; s.stamp[from] = s.epoch; s.rateOf[from] = 1.0;
+       s.queueBack[bTail++] = to; s.stampBack[to] = s.epoch; s.rateBack[to] = 1.0;
+       while (fHead < fTail && bHead < bTail) {
+           bool forward = fTail - fHead <= bTail - bHead;
+           vector<int>& q = forward ? s.queueNodes : s.queueBack;
+           vector<unsigned>& mine = forward ? s.stamp : s.stampBack;
+           vector<unsigned>& other = forward ? s.stampBack : s.stamp;
+           vector<double>& rate = forward ? s.rateOf : s.rateBack;
+           int& head = forward ? fHead : bHead;
+           int& tail = forward ? fTail : bTail;
+           int levelEnd = tail;
+           while (head < levelEnd) {
+               int curr = q[head++];
+               for (int e = g.offsets[curr]; e < g.offsets[curr + 1]; e++) {
+                   int next = g.targets[e];
+                   if (mine[next] == s.epoch) continue;
+                   mine[next] = s.epoch;
+                   rate[next] = rate[curr] * g.weights[e];
+                   q[tail++] = next;
+                   if (other[next] == s.epoch) {         // frontiers met
+                       s.visited = fTail + bTail;
+                       return s.rateOf[next] / s.rateBack[next];
+                   }
+               }
+           }
+       }
+       s.visited = fTail + bTail;
+       return -1.0;
+   }
+
+   /*
+   BFS cut off after maxHops levels (conversions with at most
+   maxHops legs). Stops as soon as the target's level is reached.
+   Time: O(nodes and edges within maxHops of `from`)
+   */
+   static double boundedRate(const CurrencyGraph& g, int from, int to, int maxHops, SearchScratch& s) {
+       if (from < 0 || to < 0) return -1.0;
+       s.prepare(g.size());
+       int head = 0, tail = 0;
+       s.queueNodes[tail++] = from;
+       s.stamp[from] = s.epoch;
+       s.rateOf[from] = 1.0;
+       for (int hop = 0; hop <= maxHops && head < tail; hop++) {
+           int levelEnd = tail;
+           for (int k = head; k < levelEnd; k++) {
+               if (s.queueNodes[k] == to) { s.visited = tail; return s.rateOf[to]; }
+           }
+           if (hop == maxHops) break;
+           while (head < levelEnd) {
+               int curr = s.queueNodes[head++];
+               for (int e = g.offsets[curr]; e < g.offsets[curr + 1]; e++) {
+                   int next = g.targets[e];
+                   if (s.stamp[next] != s.epoch) {
+                       s.stamp[next] = s.epoch;
+                       s.rateOf[next] = s.rateOf[curr] * g.weights[e];
+                       s.queueNodes[tail++] = next;
+                   }
+               }
+           }
+       }
+       s.visited = tail;
+       return -1.0;
+   }
+
+   // Full BFS from `from`; afterwards s.rateOf[v] is valid wherever s.stamp[v] == s.epoch
+   static void bfsAll(const CurrencyGraph& g, int from, SearchScratch& s) {
+       s.prepare(g.size());
+       int head = 0, tail = 0;
+       s.queueNodes[tail++] = from;
+       s.stamp[from] = s.epoch;
+       s.rateOf[from] = 1.0;
+       while (head < tail) {
+           int curr = s.queueNodes[head++];
+           for (int e = g.offsets[curr]; e < g.offsets[curr + 1]; e++) {
+               int next = g.targets[e];
+               if (s.stamp[next] != s.epoch) {
+                   s.stamp[next] = s.epoch;
+                   s.rateOf[next] = s.rateOf[curr] * g.weights[e];
+                   s.queueNodes[tail++] = next;
+               }
+           }
+       }
+       s.visited = tail;
+   }
+
 public:
+   CurrencyConverter() = default;
+   explicit CurrencyConverter(const vector<vector<string>>& rates) { loadRates(rates); }
+
+   // Parse and intern the rate table once.
+   // Time: O(V + E)
+   void loadRates(const vector<vector<string>>& rates) {
+       graph.build(rates);
+       potentials = RatePotentialIndex();
+       potentials.ensure(graph.size());
+       consistent = true;
+       for (size_t i = 0; i < graph.edgeSrc.size(); i++) {
+           if (!potentials.addRate(graph.edgeSrc[i], graph.edgeDst[i], graph.edgeRate[i]))
+               consistent = false;
+       }
+   }
+
+   /*
+   Streaming insert of rate(src -> dst) = value.
+   Merges into the potential index immediately; the CSR is
+   rebuilt lazily on the next BFS query.
+   Returns false if the rate contradicts existing rates; the
+   converter then answers Potential-mode lookups via BFS.
+   Time: O(α(V)) amortized
+   */
+   bool addRate(const string& src, const string& dst, double value) {
+       int u = graph.intern(src), v = graph.intern(dst);
+       graph.addEdge(u, v, value);
+       bool ok = potentials.addRate(u, v, value);
+       if (!ok) consistent = false;
+       return ok;
+   }
+
+   void setLookupMode(LookupMode m) { mode = m; }
+   bool isConsistent() const { return consistent; }
+
+   // Dense id of a currency, -1 if unknown. Callers on hot paths resolve once and reuse.
+   int currencyId(const string& currency) const { return graph.idOf(currency); }
+
+   // Potential mode: O(α(V)). Search mode: O(V + E) over the preloaded graph
+   double getConversionRate(int fromId, int toId) {
+       if (mode == LookupMode::Potential && consistent) return potentials.rate(fromId, toId);
+       if (graph.dirty) graph.finalize();
+       return bfsRate(graph, fromId, toId, scratch);
+   }
+
+   double getConversionRate(const string& from, const string& to) {
+       return getConversionRate(graph.idOf(from), graph.idOf(to));
+   }
+
+   // Meet-in-the-middle BFS; explores far fewer nodes on large asset graphs
+   double getConversionRateBidirectional(const string& from, const string& to) {
+       if (graph.dirty) graph.finalize();
+       return bidirectionalRate(graph, graph.idOf(from), graph.idOf(to), scratch);
+   }
+
+   // Only conversions with at most maxHops legs; -1 if none
+   double getConversionRateWithinHops(const string& from, const string& to, int maxHops) {
+       if (graph.dirty) graph.finalize();
+       return boundedRate(graph, graph.idOf(from), graph.idOf(to), maxHops, scratch);
+   }
+
+   // Nodes reached by the last single-pair search on this converter
+   int lastVisitedCount() const { return scratch.visited; }
+
+   /*
+   Resolve many (from, to) pairs at once. Queries are grouped
+   by source, each distinct source gets one full BFS that
+   answers all of its targets, and sources are split across
+   `threads` workers (each with its own scratch).
+   Time: O(Q log Q + S * (V + E) / threads), S = distinct sources
+   */
+   vector<double> convertBatch(const vector<pair<string, string>>& queries, int threads = 1) {
+       int q = (int)queries.size();
+       vector<double> result(q, -1.0);
+       vector<int> fromId(q), toId(q);
+       for (int i = 0; i < q; i++) {
+           fromId[i] = graph.idOf(queries[i].first);
+           toId[i] = graph.idOf(queries[i].second);
+       }
+       if (mode == LookupMode::Potential && consistent) {
+           for (int i = 0; i < q; i++) result[i] = potentials.rate(fromId[i], toId[i]);
+           return result;
+       }
+       if (graph.dirty) graph.finalize();
+       // Group query indices by source; groupStart marks where each distinct source begins
+       vector<int> order;
+       for (int i = 0; i < q; i++) {
+           if (fromId[i] >= 0 && toId[i] >= 0) order.push_back(i);
+       }
+       sort(order.begin(), order.end(), [&](int a, int b) { return fromId[a] < fromId[b]; });
+       vector<int> groupStart;
+       for (int k = 0; k < (int)order.size(); k++) {
+           if (k == 0 || fromId[order[k]] != fromId[order[k - 1]]) groupStart.push_back(k);
+       }
+       int groups = (int)groupStart.size();
+       groupStart.push_back((int)order.size());
+       int workers = max(1, min(threads, groups));
+       parallelFor(workers, workers, [&](int w) {
+           SearchScratch local;
+           for (int gi = groups * w / workers; gi < groups * (w + 1) / workers; gi++) {
+               bfsAll(graph, fromId[order[groupStart[gi]]], local);
+               for (int k = groupStart[gi]; k < groupStart[gi + 1]; k++) {
+                   int t = toId[order[k]];
+                   if (local.stamp[t] == local.epoch) result[order[k]] = local.rateOf[t];
+               }
+           }
+       });
+       return result;
+   }
+
    /*
    Time Complexity:
+   - Graph build: O(V + E)
    - BFS traversal: O(V + E)
    => Overall: O(V + E)
    Space Complexity:
@@ -18,49 +400,35 @@ public:
    where:
    V = number of currencies (nodes)
    E = number of conversion rates (edges)
+   One-shot form; prefer loadRates() + getConversionRate(from, to) for repeated queries.
    */
    double getConversionRate(
        vector<vector<string>>& rates,
        string from,
        string to
    ) {
-       // Step 1: Build graph
-       unordered_map<string, vector<pair<string, double>>> graph;
-       for (auto& rate : rates) {
-           string src = rate[0];
-           string dest = rate[1];
-           double value = stod(rate[2]);
-           graph[src].push_back({dest, value});
-           graph[dest].push_back({src, 1.0 / value});
-       }
-       // Edge case: currency not present
-       if (!graph.count(from) || !graph.count(to)) return -1.0;
-       // Step 2: BFS
-       queue<pair<string, double>> q;   // {currency, accumulated rate}
-       unordered_set<string> visited;
-       q.push({from, 1.0});
-       visited.insert(from);
-       while (!q.empty()) {
-           auto curr = q.front();
-           q.pop();
-           string currCurrency = curr.first;
-           double currRate = curr.second;
-           // Found target
-           if (currCurrency == to) {
-               return currRate;
-           }
-           // Explore neighbors
-           for (auto& neighbor : graph[currCurrency]) {
-               string nextCurrency = neighbor.first;
-               double rate = neighbor.second;
-               if (!visited.count(nextCurrency)) {
-                   visited.insert(nextCurrency);
-                   q.push({nextCurrency, currRate * rate});
-               }
-           }
-       }
-       // No valid conversion path
-       return -1.0;
+       CurrencyGraph oneShot;
+       oneShot.build(rates);
+       SearchScratch local;
+       return bfsRate(oneShot, oneShot.idOf(from), oneShot.idOf(to), local);
+   }
+};
+
+
+/*
+-------------------------------------------------------
+RATE STORE READER (BFS)
+-------------------------------------------------------
+Reader callback for RateStore (Currency.h): any path,
+same as getConversionRate.
+Reader query: O(V + E)
+*/
+struct AnyPathQuery {
+   SearchScratch scratch;
+
+   double operator()(const CurrencyGraph& g, int from, int to) {
+       return CurrencyConverter::bfsRate(g, from, to, scratch);
    }
 };
 
+using AnyPathRateStore = RateStore<AnyPathQuery>;
@@ -2,57 +2,927 @@
 #include <vector>
 #include <unordered_map>
 #include <queue>
+#include <string>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <stdexcept>
+#include <set>
+#include <deque>
+#include "Currency.h"
 using namespace std;
 
 
+/*
+-------------------------------------------------------
+SEARCH SCRATCH
+-------------------------------------------------------
+Reusable per-thread buffers for Dijkstra. `stamp` marks
+bestRate[v] as valid for the current query (== epoch).
+*/
+struct SearchScratch {
+   vector<unsigned> stamp;
+   vector<double> bestRate;
+   vector<pair<double, int>> heap;                      // max heap storage (rate, id)
+   vector<unsigned> stampBack;                          // backward side of bidirectional search
+   vector<double> bestBack;                             // reduced distance v -> target
+   vector<pair<double, int>> heapBack;
+   vector<double> hopRate, hopNext;                     // bounded Bellman–Ford rounds
+   unsigned epoch = 0;
+   int visited = 0;                                     // nodes reached by the last query
+
+   void prepare(int n) {
+       if ((int)stamp.size() < n) { stamp.resize(n, 0); bestRate.resize(n); }
+       heap.clear();
+       visited = 0;
+       if (++epoch == 0) {                              // wrapped: reset stamps once
+           fill(stamp.begin(), stamp.end(), 0);
+           fill(stampBack.begin(), stampBack.end(), 0);
+           epoch = 1;
+       }
+   }
+
+   void prepareBackward(int n) {
+       if ((int)stampBack.size() < n) { stampBack.resize(n, 0); bestBack.resize(n); }
+       heapBack.clear();
+   }
+};
+
+
+const double RATE_EPSILON = 1e-12;                      // relative tolerance for "better rate"
+
+
+/*
+-------------------------------------------------------
+REDUCED COSTS (Johnson reweighting)
+-------------------------------------------------------
+potential[v] = shortest -log distance from a virtual
+source linked to every currency (SPFA). With no
+arbitrage it is feasible, so
+   cost'(u, v) = -log(rate) + potential[u] - potential[v] >= 0
+and any path's real cost is its reduced cost plus
+potential[to] - potential[from]. `out` covers CSR
+entries as stored, `in` their mirrored in-edges.
+Build: O(V * E) worst case, near O(E) in practice
+*/
+struct ReducedCosts {
+   bool valid = false;                                  // false if an arbitrage cycle was found
+   vector<double> potential;
+   vector<double> out, in;
+
+   void build(const CurrencyGraph& g) {
+       int n = g.size();
+       potential.assign(n, 0.0);
+       vector<int> hops(n, 0);
+       vector<char> inQueue(n, 1);
+       deque<int> q;
+       for (int v = 0; v < n; v++) q.push_back(v);
+       valid = true;
+       while (!q.empty() && valid) {
+           int u = q.front(); q.pop_front();
+           inQueue[u] = 0;
+           for (int e = g.offsets[u]; e < g.offsets[u + 1]; e++) {
+               int v = g.targets[e];
+               double cand = potential[u] - log(g.weights[e]);
+               if (cand >= potential[v] - RATE_EPSILON) continue;
+               potential[v] = cand;
+               hops[v] = hops[u] + 1;
+               if (hops[v] >= n) { valid = false; break; }
+               if (!inQueue[v]) { inQueue[v] = 1; q.push_back(v); }
+           }
+       }
+       out.assign(g.targets.size(), 0.0);
+       in.assign(g.targets.size(), 0.0);
+       if (!valid) return;
+       for (int u = 0; u < n; u++) {
+           for (int e = g.offsets[u]; e < g.offsets[u + 1]; e++) {
+               int v = g.targets[e];
+               // clamp rounding noise so Dijkstra never sees a negative edge
+               out[e] = max(0.0, -log(g.weights[e]) + potential[u] - potential[v]);
+               in[e] = max(0.0, -log(g.inRates[e]) + potential[v] - potential[u]);
+           }
+       }
+   }
+};
+
+
+/*
+-------------------------------------------------------
+BEST RATE MATRIX (all pairs, log-domain Floyd–Warshall)
+-------------------------------------------------------
+dist[i][j] = -log(best rate i -> j), so maximizing a
+product becomes minimizing a sum. The matrix is padded
+to a multiple of BLOCK and processed in the classic
+three-phase blocked order: diagonal block, then its row
+and column of blocks, then every remaining block. The
+innermost loop is a contiguous min(a, b + c) over a row,
+which the compiler vectorizes. Improvements below
+RATE_EPSILON are dropped, otherwise rounding noise on
+r * (1/r) round trips compounds like a negative cycle. Phase 2 and 3 blocks are
+independent and are spread over threads.
+Build: O(V^3)   Lookup: O(1)   Space: O(V^2)
+Assumes no arbitrage cycles (same as Dijkstra below).
+*/
+class BestRateMatrix {
+private:
+   static constexpr int BLOCK = 64;
+   int n = 0;                                           // number of currencies
+   int stride = 0;                                      // padded row length
+   vector<double> dist;                                 // row-major stride x stride
+
+   // Relax block (ib, jb) through intermediates in block kb
+   void relaxBlock(int ib, int jb, int kb) {
+       const double inf = numeric_limits<double>::infinity();
+       double rowK[BLOCK];                              // local copy: no aliasing with rowI
+       for (int k = kb; k < kb + BLOCK; k++) {
+           copy_n(&dist[(size_t)k * stride + jb], BLOCK, rowK);
+           for (int i = ib; i < ib + BLOCK; i++) {
+               double* rowI = &dist[(size_t)i * stride + jb];
+               double dik = dist[(size_t)i * stride + k];
+               if (dik == inf) continue;
+               for (int j = 0; j < BLOCK; j++) {
+                   double through = dik + rowK[j];
+                   rowI[j] = through < rowI[j] - RATE_EPSILON ? through : rowI[j];
+               }
+           }
+       }
+   }
+
+public:
+   bool empty() const { return n == 0; }
+
+   void build(const CurrencyGraph& g, int threads = 1) {
+       const double inf = numeric_limits<double>::infinity();
+       n = g.size();
+       stride = (n + BLOCK - 1) / BLOCK * BLOCK;
+       dist.assign((size_t)stride * stride, inf);
+       for (int i = 0; i < stride; i++) dist[(size_t)i * stride + i] = 0.0;
+       for (int u = 0; u < n; u++) {
+           for (int e = g.offsets[u]; e < g.offsets[u + 1]; e++) {
+               if (g.weights[e] <= 0) continue;         // not a usable rate
+               double& d = dist[(size_t)u * stride + g.targets[e]];
+               d = min(d, -log(g.weights[e]));
+           }
+       }
+       int blocks = stride / BLOCK;
+       for (int kb = 0; kb < blocks; kb++) {
+           int k0 = kb * BLOCK;
+           // Phase 1: diagonal block depends only on itself
+           relaxBlock(k0, k0, k0);
+           // Phase 2: blocks sharing a row or column with the diagonal
+           parallelFor(2 * blocks, threads, [&](int idx) {
+               int b = idx % blocks;
+               if (b == kb) return;
+               if (idx < blocks) relaxBlock(k0, b * BLOCK, k0);
+               else relaxBlock(b * BLOCK, k0, k0);
+           });
+           // Phase 3: everything else, one worker per row of blocks
+           parallelFor(blocks, threads, [&](int ib) {
+               if (ib == kb) return;
+               for (int jb = 0; jb < blocks; jb++) {
+                   if (jb != kb) relaxBlock(ib * BLOCK, jb * BLOCK, k0);
+               }
+           });
+       }
+   }
+
+   // Best rate from -> to, -1 if unreachable
+   double rate(int from, int to) const {
+       if (from < 0 || to < 0 || from >= n || to >= n) return -1.0;
+       double d = dist[(size_t)from * stride + to];
+       return d == numeric_limits<double>::infinity() ? -1.0 : exp(-d);
+   }
+};
+
+
+/*
+-------------------------------------------------------
+DYNAMIC BEST RATES (incremental single-source trees)
+-------------------------------------------------------
+Keeps a best-rate tree for every registered source over
+the converter's CurrencyGraph (no graph of its own).
+Rates are kept as products, relaxed exactly like the
+max-product Dijkstra, so a tracked answer is the rate
+getMaxConversionRate would compute. When CurrencyGraph::
+setRate changes one rate pair, each tree is repaired in
+the spirit of Ramalingam–Reps:
+ - rate got better: relax the slot and propagate only
+   from its head while rates keep improving
+ - rate got worse on a tree edge: detach the subtree
+   under it, re-seed those nodes from their best in-edge
+   outside the subtree, propagate inside
+Anything outside the affected region is untouched.
+Read: O(1)   Repair: proportional to affected nodes/edges
+Assumes no arbitrage cycles (see BestRateMatrix); paths
+are capped at V hops so a cycle cannot stall a repair.
+*/
+class DynamicBestRates {
+public:
+   struct SlotChange {
+       int from;                                        // node owning the CSR slot
+       int slot;
+       double oldRate;                                  // weight before setRate
+   };
+
+private:
+   struct Tree {
+       int source;
+       vector<double> rate;                             // best rate source -> v, 0 = unreachable
+       vector<int> parent;                              // predecessor node, -1 if none
+       vector<int> hops;                                // tree depth, bounds work under arbitrage
+   };
+
+   vector<Tree> trees;
+   unordered_map<int, int> treeOfSource;                // source id -> index in trees
+   vector<string> sources;                              // registered names (ids change on reload)
+   vector<char> inSubtree;                              // scratch for worsened-edge repair
+   vector<pair<double, int>> heap;                      // scratch max heap (rate, node)
+
+   void push(int node, double r) {
+       heap.push_back({r, node});
+       push_heap(heap.begin(), heap.end());
+   }
+
+   void setParent(Tree& t, int v, int u, double r) {
+       t.rate[v] = r;
+       t.parent[v] = u;
+       t.hops[v] = t.hops[u] + 1;
+   }
+
+   // Label-correcting propagation from whatever is queued in heap.
+   // A path longer than V hops can only come from an arbitrage cycle; it is not extended.
+   void propagate(const CurrencyGraph& g, Tree& t) {
+       int n = g.size();
+       while (!heap.empty()) {
+           pop_heap(heap.begin(), heap.end());
+           auto [r, x] = heap.back();
+           heap.pop_back();
+           if (r < t.rate[x] || t.hops[x] >= n) continue;  // outdated entry / cycling
+           for (int e = g.offsets[x]; e < g.offsets[x + 1]; e++) {
+               int y = g.targets[e];
+               double nr = r * g.weights[e];
+               if (nr > t.rate[y] * (1 + RATE_EPSILON)) {
+                   setParent(t, y, x, nr);
+                   push(y, nr);
+               }
+           }
+       }
+   }
+
+   void rebuildTree(const CurrencyGraph& g, Tree& t) {
+       int n = g.size();
+       t.rate.assign(n, 0.0);
+       t.parent.assign(n, -1);
+       t.hops.assign(n, 0);
+       t.rate[t.source] = 1.0;
+       push(t.source, 1.0);
+       propagate(g, t);
+   }
+
+   // Slot `slot` of node u (u -> targets[slot]) became better
+   void repairImproved(const CurrencyGraph& g, Tree& t, int u, int slot) {
+       if (t.rate[u] == 0.0) return;
+       int v = g.targets[slot];
+       double nr = t.rate[u] * g.weights[slot];
+       if (nr <= t.rate[v] * (1 + RATE_EPSILON)) return;
+       setParent(t, v, u, nr);
+       push(v, nr);
+       propagate(g, t);
+   }
+
+   // Slot `slot` of node u became worse; setRate changes every u - v edge alike, so it was the
+   // tree edge into v iff v's parent is u
+   void repairWorsened(const CurrencyGraph& g, Tree& t, int u, int slot) {
+       int v = g.targets[slot];
+       if (t.parent[v] != u) return;                    // not a tree edge: nothing depends on it
+       // Collect the subtree hanging below v
+       vector<int> subtree = {v};
+       inSubtree[v] = 1;
+       for (size_t k = 0; k < subtree.size(); k++) {
+           int x = subtree[k];
+           for (int e = g.offsets[x]; e < g.offsets[x + 1]; e++) {
+               int y = g.targets[e];
+               if (!inSubtree[y] && t.parent[y] == x) {
+                   inSubtree[y] = 1;
+                   subtree.push_back(y);
+               }
+           }
+       }
+       for (int x : subtree) {
+           t.rate[x] = 0.0;
+           t.parent[x] = -1;
+       }
+       // Re-seed each detached node from its best in-edge outside the subtree
+       for (int x : subtree) {
+           for (int e = g.offsets[x]; e < g.offsets[x + 1]; e++) {
+               int y = g.targets[e];                    // in-edge y -> x has rate inRates[e]
+               if (inSubtree[y] || t.rate[y] == 0.0) continue;
+               double nr = t.rate[y] * g.inRates[e];
+               if (nr > t.rate[x] * (1 + RATE_EPSILON)) setParent(t, x, y, nr);
+           }
+           if (t.rate[x] > 0.0) push(x, t.rate[x]);
+       }
+       for (int x : subtree) inSubtree[x] = 0;
+       propagate(g, t);
+   }
+
+public:
+   // Start maintaining the tree of `source`; an unknown source is tracked once it appears
+   // Time: O(E log V) once
+   void registerSource(const CurrencyGraph& g, const string& source) {
+       if (find(sources.begin(), sources.end(), source) != sources.end()) return;
+       sources.push_back(source);
+       int id = g.idOf(source);
+       if (id < 0) return;
+       inSubtree.resize(g.size(), 0);
+       treeOfSource[id] = (int)trees.size();
+       trees.push_back({id, {}, {}, {}});
+       rebuildTree(g, trees.back());
+   }
+
+   // After a reload or a new edge (ids and CSR slots may have changed): rebuild every tree
+   // Time: O(S * E log V), S = registered sources
+   void rebuild(const CurrencyGraph& g) {
+       trees.clear();
+       treeOfSource.clear();
+       inSubtree.assign(g.size(), 0);
+       for (auto& source : sources) {
+           int id = g.idOf(source);
+           if (id < 0 || treeOfSource.count(id)) continue;
+           treeOfSource[id] = (int)trees.size();
+           trees.push_back({id, {}, {}, {}});
+           rebuildTree(g, trees.back());
+       }
+   }
+
+   // After CurrencyGraph::setRate: repair every tree for the slots it changed
+   void repair(const CurrencyGraph& g, const vector<SlotChange>& changes) {
+       for (auto& t : trees) {
+           // Worsened slots first, so improvements propagate over a valid tree
+           for (auto& c : changes) {
+               if (g.weights[c.slot] < c.oldRate) repairWorsened(g, t, c.from, c.slot);
+           }
+           for (auto& c : changes) {
+               if (g.weights[c.slot] > c.oldRate) repairImproved(g, t, c.from, c.slot);
+           }
+       }
+   }
+
+   // Best rate from -> to if `from` is tracked (-1 if unreachable); false otherwise
+   bool lookup(int from, int to, double& result) const {
+       auto it = treeOfSource.find(from);
+       if (it == treeOfSource.end() || to < 0) return false;
+       double r = trees[it->second].rate[to];
+       result = r > 0.0 ? r : -1.0;
+       return true;
+   }
+};
+
+
 class CurrencyConverter {
+private:
+   friend struct BestRateQuery;                         // RateStore reader shares the search routine
+   CurrencyGraph graph;                                 // loaded once, queried many times
+   SearchScratch scratch;
+   BestRateMatrix bestRates;                            // optional all-pairs precompute
+   DynamicBestRates trackedRates;                       // best-rate trees of registered sources
+   ReducedCosts reduced;                                // built on first bidirectional query
+   bool reducedReady = false;
+
+   /*
+   Max-product Dijkstra over dense ids on the CSR graph.
+   Time Complexity: O(E log V), no allocation after warm-up
+   */
+   static double dijkstraRate(const CurrencyGraph& g, int from, int to, SearchScratch& s) {
+       if (from < 0 || to < 0) return -1.0;
+       s.prepare(g.size());
+       auto& pq = s.heap;
+       pq.push_back({1.0, from});
+       s.stamp[from] = s.epoch;
+       s.bestRate[from] = 1.0;
+       s.visited = 1;
+       while (!pq.empty()) {
+           pop_heap(pq.begin(), pq.end());
+           auto [currRate, curr] = pq.back();
+           pq.pop_back();
+           // If reached target → best possible due to max heap
+           if (curr == to) return currRate;
+           // Skip outdated entries
+           if (currRate < s.bestRate[curr]) continue;
+           for (int e = g.offsets[curr]; e < g.offsets[curr + 1]; e++) {
+               int next = g.targets[e];
+               double newRate = currRate * g.weights[e];
+               // Relaxation step (maximize instead of minimize); gains within
+               // rounding error are ignored so r * (1/r) round trips cannot loop forever
+               if (s.stamp[next] != s.epoch || newRate > s.bestRate[next] * (1 + RATE_EPSILON)) {
+                   if (s.stamp[next] != s.epoch) s.visited++;
+                   s.stamp[next] = s.epoch;
+                   s.bestRate[next] = newRate;
+                   pq.push_back({newRate, next});
+                   push_heap(pq.begin(), pq.end());
+               }
+           }
+       }
+       return -1.0;
+   }
+
+   /*
+   Bidirectional Dijkstra over reduced costs (see ReducedCosts).
+   Both sides pop the smallest reduced distance; the smaller
+   heap is expanded next. `best` is the cheapest meeting
+   found, and the search stops once topF + topB cannot beat
+   it. Reduced costs are non-negative, which is what makes
+   that stopping rule exact even though half of the raw
+   -log rates are negative.
+   Time: O(E log V) worst case, typically far fewer nodes
+   */
+   static double bidirectionalRate(const CurrencyGraph& g, const ReducedCosts& rc, int from, int to, SearchScratch& s) {
+       if (from < 0 || to < 0) return -1.0;
+       s.prepareBackward(g.size());
+       s.prepare(g.size());
+       auto cmp = greater<pair<double, int>>();         // min heaps on reduced distance
+       s.heap.push_back({0.0, from}); s.stamp[from] = s.epoch; s.bestRate[from] = 0.0;
+       s.heapBack.push_back({0.0, to}); s.stampBack[to] = s.epoch; s.bestBack[to] = 0.0;
+       s.visited = from == to ? 1 : 2;
+       const double inf = numeric_limits<double>::infinity();
+       double best = from == to ? 0.0 : inf;
+       while (!s.heap.empty() && !s.heapBack.empty()) {
+           if (s.heap.front().first + s.heapBack.front().first >= best - RATE_EPSILON) break;
+           bool forward = s.heap.size() <= s.heapBack.size();
+           auto& pq = forward ? s.heap : s.heapBack;
+           auto& mine = forward ? s.stamp : s.stampBack;
+           auto& other = forward ? s.stampBack : s.stamp;
+           auto& dist = forward ? s.bestRate : s.bestBack;  // reduced distances here, not rates
+           auto& otherDist = forward ? s.bestBack : s.bestRate;
+           const vector<double>& edgeCost = forward ? rc.out : rc.in;
+           pop_heap(pq.begin(), pq.end(), cmp);
+           auto [d, curr] = pq.back();
+           pq.pop_back();
+           if (d > dist[curr]) continue;                // outdated entry
+           for (int e = g.offsets[curr]; e < g.offsets[curr + 1]; e++) {
+               int next = g.targets[e];
+               double nd = d + edgeCost[e];
+               if (mine[next] == s.epoch && nd >= dist[next] - RATE_EPSILON) continue;
+               if (mine[next] != s.epoch && other[next] != s.epoch) s.visited++;
+               mine[next] = s.epoch;
+               dist[next] = nd;
+               pq.push_back({nd, next});
+               push_heap(pq.begin(), pq.end(), cmp);
+               if (other[next] == s.epoch) best = min(best, nd + otherDist[next]);
+           }
+       }
+       if (best == inf) return -1.0;
+       // Undo the reweighting: real cost = reduced + potential[to] - potential[from]
+       return exp(-(best + rc.potential[to] - rc.potential[from]));
+   }
+
+   /*
+   Best rate using at most maxHops legs: maxHops Jacobi
+   rounds of Bellman–Ford over the CSR arrays, each node
+   gathering max(rate[u] * inRate) over its in-edges. The
+   loop is branch-free and stride-1 over the edge arrays.
+   Stops early once a round changes nothing.
+   Time: O(maxHops * (V + E))
+   */
+   static double boundedRate(const CurrencyGraph& g, int from, int to, int maxHops, SearchScratch& s) {
+       if (from < 0 || to < 0) return -1.0;
+       int n = g.size();
+       s.hopRate.assign(n, 0.0);                        // 0 = not reached yet
+       s.hopNext.resize(n);
+       s.hopRate[from] = 1.0;
+       const int* offsets = g.offsets.data();
+       const int* targets = g.targets.data();
+       const double* inRates = g.inRates.data();
+       for (int hop = 0; hop < maxHops; hop++) {
+           const double* cur = s.hopRate.data();
+           double* next = s.hopNext.data();
+           bool changed = false;
+           for (int v = 0; v < n; v++) {
+               double best = cur[v];
+               for (int e = offsets[v]; e < offsets[v + 1]; e++) {
+                   double cand = cur[targets[e]] * inRates[e];
+                   best = cand > best ? cand : best;
+               }
+               changed |= best > cur[v] * (1 + RATE_EPSILON);
+               next[v] = best;
+           }
+           s.hopRate.swap(s.hopNext);
+           if (!changed) break;
+       }
+       s.visited = (int)count_if(s.hopRate.begin(), s.hopRate.end(), [](double r) { return r > 0; });
+       return s.hopRate[to] > 0 ? s.hopRate[to] : -1.0;
+   }
+
+   // Full Dijkstra from `from`; afterwards s.bestRate[v] is valid wherever s.stamp[v] == s.epoch
+   static void dijkstraAll(const CurrencyGraph& g, int from, SearchScratch& s) {
+       s.prepare(g.size());
+       auto& pq = s.heap;
+       pq.push_back({1.0, from});
+       s.stamp[from] = s.epoch;
+       s.bestRate[from] = 1.0;
+       while (!pq.empty()) {
+           pop_heap(pq.begin(), pq.end());
+           auto [currRate, curr] = pq.back();
+           pq.pop_back();
+           if (currRate < s.bestRate[curr]) continue;
+           for (int e = g.offsets[curr]; e < g.offsets[curr + 1]; e++) {
+               int next = g.targets[e];
+               double newRate = currRate * g.weights[e];
+               if (s.stamp[next] != s.epoch || newRate > s.bestRate[next] * (1 + RATE_EPSILON)) {
+                   s.stamp[next] = s.epoch;
+                   s.bestRate[next] = newRate;
+                   pq.push_back({newRate, next});
+                   push_heap(pq.begin(), pq.end());
+               }
+           }
+       }
+   }
+
 public:
+   CurrencyConverter() = default;
+   explicit CurrencyConverter(const vector<vector<string>>& rates) { loadRates(rates); }
+
+   // Parse and intern the rate table once.
+   // Time: O(V + E)
+   void loadRates(const vector<vector<string>>& rates) {
+       graph.build(rates);
+       bestRates = BestRateMatrix();                    // stale after a reload
+       reducedReady = false;
+       trackedRates.rebuild(graph);
+   }
+
+   /*
+   Keep the best rates out of `source` up to date, so
+   getMaxConversionRate from it is O(1) across updateRate().
+   A currency not loaded yet is tracked once it appears.
+   Time: O(E log V) once
+   */
+   void registerSource(const string& source) {
+       trackedRates.registerSource(graph, source);
+   }
+
+   /*
+   Set rate(src -> dst) = value (and dst -> src = 1 / value)
+   on every edge between the two, in place, and repair the
+   tracked trees. A new pair is appended and the CSR and
+   trees are rebuilt. Drops the all-pairs matrix.
+   Time: proportional to the affected tree nodes / edges
+         (new pair: O(V + E + S * E log V))
+   */
+   void updateRate(const string& src, const string& dst, double value) {
+       bestRates = BestRateMatrix();                    // stale now
+       reducedReady = false;
+       int u = graph.idOf(src), v = graph.idOf(dst);
+       auto [first, last] = graph.edgesBetween.equal_range(CurrencyGraph::pairKey(u, v));
+       if (u < 0 || v < 0 || first == last) {
+           graph.addEdge(graph.intern(src), graph.intern(dst), value);
+           graph.finalize();
+           trackedRates.rebuild(graph);
+           return;
+       }
+       vector<DynamicBestRates::SlotChange> changes;
+       for (auto it = first; it != last; ++it) {
+           int i = it->second;
+           changes.push_back({graph.edgeSrc[i], graph.forwardSlot[i], graph.weights[graph.forwardSlot[i]]});
+           changes.push_back({graph.edgeDst[i], graph.backwardSlot[i], graph.weights[graph.backwardSlot[i]]});
+       }
+       graph.setRate(u, v, value);
+       trackedRates.repair(graph, changes);
+   }
+
+   /*
+   Precompute every pair's best rate; afterwards
+   getMaxConversionRate is a single array read until the
+   next loadRates() or updateRate(). Call on each refresh.
+   Time: O(V^3 / threads)   Space: O(V^2)
+   */
+   void precomputeBestRates(int threads = 1) {
+       bestRates.build(graph, threads);
+   }
+
+   // Dense id of a currency, -1 if unknown. Callers on hot paths resolve once and reuse.
+   int currencyId(const string& currency) const { return graph.idOf(currency); }
+
+   // Time: O(1) after precomputeBestRates() or from a registered source,
+   // else O(E log V) over the preloaded graph
+   double getMaxConversionRate(int fromId, int toId) {
+       if (!bestRates.empty()) return bestRates.rate(fromId, toId);
+       double tracked;
+       if (trackedRates.lookup(fromId, toId, tracked)) return tracked;
+       return dijkstraRate(graph, fromId, toId, scratch);
+   }
+
+   double getMaxConversionRate(const string& from, const string& to) {
+       return getMaxConversionRate(graph.idOf(from), graph.idOf(to));
+   }
+
+   // Meet-in-the-middle Dijkstra; explores far fewer nodes on large asset graphs.
+   // Falls back to one-sided Dijkstra if the table contains arbitrage.
+   double getMaxConversionRateBidirectional(const string& from, const string& to) {
+       if (!reducedReady) { reduced.build(graph); reducedReady = true; }
+       if (!reduced.valid) return getMaxConversionRate(from, to);
+       return bidirectionalRate(graph, reduced, graph.idOf(from), graph.idOf(to), scratch);
+   }
+
+   // Best rate over conversions with at most maxHops legs; -1 if none
+   double getMaxConversionRateWithinHops(const string& from, const string& to, int maxHops) {
+       return boundedRate(graph, graph.idOf(from), graph.idOf(to), maxHops, scratch);
+   }
+
+   // Nodes reached by the last single-pair search on this converter
+   int lastVisitedCount() const { return scratch.visited; }
+
+   /*
+   Resolve many (from, to) pairs at once. Queries are grouped
+   by source, each distinct source gets one full max-heap
+   Dijkstra that answers all of its targets, and sources are
+   split across `threads` workers (each with its own scratch).
+   Time: O(Q log Q + S * E log V / threads), S = distinct sources
+   */
+   vector<double> convertBatch(const vector<pair<string, string>>& queries, int threads = 1) {
+       int q = (int)queries.size();
+       vector<double> result(q, -1.0);
+       vector<int> fromId(q), toId(q);
+       for (int i = 0; i < q; i++) {
+           fromId[i] = graph.idOf(queries[i].first);
+           toId[i] = graph.idOf(queries[i].second);
+       }
+       if (!bestRates.empty()) {
+           for (int i = 0; i < q; i++) result[i] = bestRates.rate(fromId[i], toId[i]);
+           return result;
+       }
+       // Group query indices by source; groupStart marks where each distinct source begins
+       vector<int> order;
+       for (int i = 0; i < q; i++) {
+           if (fromId[i] >= 0 && toId[i] >= 0) order.push_back(i);
+       }
+       sort(order.begin(), order.end(), [&](int a, int b) { return fromId[a] < fromId[b]; });
+       vector<int> groupStart;
+       for (int k = 0; k < (int)order.size(); k++) {
+           if (k == 0 || fromId[order[k]] != fromId[order[k - 1]]) groupStart.push_back(k);
+       }
+       int groups = (int)groupStart.size();
+       groupStart.push_back((int)order.size());
+       int workers = max(1, min(threads, groups));
+       parallelFor(workers, workers, [&](int w) {
+           SearchScratch local;
+           for (int gi = groups * w / workers; gi < groups * (w + 1) / workers; gi++) {
+               dijkstraAll(graph, fromId[order[groupStart[gi]]], local);
+               for (int k = groupStart[gi]; k < groupStart[gi + 1]; k++) {
+                   int t = toId[order[k]];
+                   if (local.stamp[t] == local.epoch) result[order[k]] = local.bestRate[t];
+               }
+           }
+       });
+       return result;
+   }
+
    /*
    Time Complexity: O(E log V)
    Space Complexity: O(V + E)
    V = number of currencies
    E = number of conversion rates
+   One-shot form; prefer loadRates() + getMaxConversionRate(from, to) for repeated queries.
    */
    double getMaxConversionRate(
        vector<vector<string>>& rates,
        string from,
        string to
    ) {
-       // Step 1: Build graph
-       unordered_map<string, vector<pair<string, double>>> graph;
-       for (auto& rate : rates) {
-           string src = rate[0];
-           string dest = rate[1];
-           double value = stod(rate[2]);
-           graph[src].push_back({dest, value});
-           graph[dest].push_back({src, 1.0 / value});
-       }
-       // Edge case
-       if (!graph.count(from) || !graph.count(to)) return -1.0;
-       // Step 2: Max Heap (rate, currency)
-       priority_queue<pair<double, string>> pq;
-       unordered_map<string, double> bestRate;
-       pq.push({1.0, from});
-       bestRate[from] = 1.0;
-       while (!pq.empty()) {
-           auto [currRate, currCurrency] = pq.top();
-           pq.pop();
-           // If reached target → best possible due to max heap
-           if (currCurrency == to) return currRate;
-           // Skip outdated entries
-           if (currRate < bestRate[currCurrency]) continue;
-           for (auto& neighbor : graph[currCurrency]) {
-               string nextCurrency = neighbor.first;
-               double rate = neighbor.second;
-               double newRate = currRate * rate;
-               // Relaxation step (maximize instead of minimize)
-               if (!bestRate.count(nextCurrency) || newRate > bestRate[nextCurrency]) {
-                   bestRate[nextCurrency] = newRate;
-                   pq.push({newRate, nextCurrency});
+       CurrencyGraph oneShot;
+       oneShot.build(rates);
+       SearchScratch local;
+       return dijkstraRate(oneShot, oneShot.idOf(from), oneShot.idOf(to), local);
+   }
+};
+
+
+/*
+-------------------------------------------------------
+RATE STORE READER (Dijkstra)
+-------------------------------------------------------
+Reader callback for RateStore (Currency.h): best rate,
+same as getMaxConversionRate.
+Reader query: O(E log V)
+*/
+struct BestRateQuery {
+   SearchScratch scratch;
+
+   double operator()(const CurrencyGraph& g, int from, int to) {
+       return CurrencyConverter::dijkstraRate(g, from, to, scratch);
+   }
+};
+
+using BestRateStore = RateStore<BestRateQuery>;
+
+
+
+/*
+-------------------------------------------------------
+ARBITRAGE DETECTOR (negative cycles in -log space)
+-------------------------------------------------------
+A cycle whose rate product exceeds 1 is a negative cycle
+under cost = -log(rate).
+detectAll(): Bellman–Ford from a virtual source linked
+   to every currency (i.e. all sources at once), in
+   Jacobi rounds so each worker owns a fixed slice of
+   currencies and results are thread-count independent.
+   Time: O(V * E / threads)
+detectChanged(): after a clean run the final distances
+   are a feasible potential. Only edges changed since
+   then can violate it, so SPFA restarts from their
+   endpoints and touches just the region whose potential
+   must drop; a path reaching V hops exposes a cycle.
+   Time: proportional to the affected region
+*/
+struct ArbitrageCycle {
+   vector<string> currencies;                           // c0 -> c1 -> ... -> back to c0
+   double gain;                                         // product of rates around the cycle (> 1)
+};
+
+class ArbitrageDetector {
+private:
+   // Reusable barrier for workers that advance in lock-step rounds
+   class SpinBarrier {
+       atomic<int> arrived{0};
+       atomic<int> generation{0};
+       int total;
+   public:
+       explicit SpinBarrier(int n) : total(n) {}
+       void wait() {
+           int gen = generation.load();
+           if (arrived.fetch_add(1) + 1 == total) {
+               arrived.store(0);
+               generation.fetch_add(1);
+           } else {
+               while (generation.load() == gen) this_thread::yield();
+           }
+       }
+   };
+
+   CurrencyGraph graph;
+   int threads;
+   vector<double> cost;                                 // cost[e] = -log(weights[e])
+   vector<double> potential;                            // feasible distances after a clean run
+   bool potentialValid = false;
+   vector<int> dirtyNodes;                              // endpoints of rates changed since last run
+   vector<int> changedSlots;                            // scratch: CSR entries touched by updateRate
+
+   void refreshCosts() {
+       cost.resize(graph.weights.size());
+       for (size_t e = 0; e < cost.size(); e++) cost[e] = -log(graph.weights[e]);
+   }
+
+   // Walk predecessors from v onto a cycle and record it once (rotated to its smallest id)
+   void extractCycle(int v, const vector<int>& pred, const vector<double>& predCost,
+                     set<vector<int>>& seen, vector<ArbitrageCycle>& out) {
+       int n = graph.size();
+       for (int i = 0; i < n && v >= 0; i++) v = pred[v];
+       if (v < 0) return;
+       vector<int> cycle;
+       double total = 0;
+       int x = v;
+       do {
+           cycle.push_back(x);
+           total += predCost[x];
+           x = pred[x];
+       } while (x != v && x >= 0 && (int)cycle.size() <= n);
+       if (x != v) return;
+       reverse(cycle.begin(), cycle.end());             // pred walk is backwards
+       rotate(cycle.begin(), min_element(cycle.begin(), cycle.end()), cycle.end());
+       if (total >= -RATE_EPSILON || !seen.insert(cycle).second) return;
+       ArbitrageCycle found{{}, exp(-total)};
+       for (int id : cycle) found.currencies.push_back(graph.names[id]);
+       out.push_back(found);
+   }
+
+public:
+   explicit ArbitrageDetector(const CurrencyGraph& g, int threads = 1) : graph(g), threads(max(1, threads)) {
+       refreshCosts();
+   }
+
+   vector<ArbitrageCycle> detectAll() {
+       int n = graph.size();
+       vector<ArbitrageCycle> cycles;
+       if (n == 0) return cycles;
+       // Double buffers indexed by round parity
+       vector<double> dist[2] = {vector<double>(n, 0.0), vector<double>(n, 0.0)};
+       vector<int> pred[2] = {vector<int>(n, -1), vector<int>(n, -1)};
+       vector<double> predCost[2] = {vector<double>(n, 0.0), vector<double>(n, 0.0)};
+       int workers = min(threads, n);
+       vector<char> changedFlag[2] = {vector<char>(workers, 0), vector<char>(workers, 0)};
+       int lastRound = 0;
+       SpinBarrier barrier(workers);
+
+       auto work = [&](int w) {
+           int lo = (int)((long long)n * w / workers), hi = (int)((long long)n * (w + 1) / workers);
+           for (int round = 1; round <= n; round++) {
+               int cur = (round - 1) & 1, nxt = round & 1;
+               bool changed = false;
+               for (int v = lo; v < hi; v++) {
+                   double best = dist[cur][v];
+                   int bestPred = pred[cur][v];
+                   double bestCost = predCost[cur][v];
+                   // In-edge u -> v mirrors CSR entry v -> u and costs -cost[e]
+                   for (int e = graph.offsets[v]; e < graph.offsets[v + 1]; e++) {
+                       double cand = dist[cur][graph.targets[e]] - cost[e];
+                       if (cand < best - RATE_EPSILON) {
+                           best = cand; bestPred = graph.targets[e]; bestCost = -cost[e];
+                           changed = true;
+                       }
+                   }
+                   dist[nxt][v] = best; pred[nxt][v] = bestPred; predCost[nxt][v] = bestCost;
                }
+               changedFlag[nxt][w] = changed;
+               barrier.wait();
+               bool any = false;
+               for (char f : changedFlag[nxt]) any = any || f;
+               if (w == 0) lastRound = round;
+               if (!any) return;
+           }
+       };
+       vector<thread> pool;
+       for (int w = 1; w < workers; w++) pool.emplace_back(work, w);
+       work(0);
+       for (auto& t : pool) t.join();
+
+       int last = lastRound & 1;
+       bool stillChanging = false;
+       for (char f : changedFlag[last]) stillChanging = stillChanging || f;
+       if (stillChanging) {
+           // Something still improved after V rounds: every such node hangs off a cycle
+           set<vector<int>> seen;
+           for (int v = 0; v < n; v++) {
+               if (dist[last][v] < dist[last ^ 1][v]) extractCycle(v, pred[last], predCost[last], seen, cycles);
            }
        }
-       return -1.0;
+       potential = dist[last];
+       potentialValid = !stillChanging;
+       dirtyNodes.clear();
+       return cycles;
    }
-};
 
+   /*
+   Apply rate(src -> dst) = value to the detector's graph and
+   remember both endpoints for the next detectChanged().
+   Time: O(edges between src and dst) for a known pair,
+   O(V + E) when the pair is new (CSR rebuild)
+   */
+   void updateRate(const string& src, const string& dst, double value) {
+       int u = graph.intern(src), v = graph.intern(dst);
+       changedSlots.clear();
+       if (graph.setRate(u, v, value, &changedSlots)) {
+           for (int e : changedSlots) cost[e] = -log(graph.weights[e]);   // only this pair's entries
+       } else {
+           graph.addEdge(u, v, value);                  // new pair: CSR is rebuilt, so are all costs
+           graph.finalize();
+           refreshCosts();
+       }
+       potential.resize(graph.size(), 0.0);
+       dirtyNodes.push_back(u);
+       dirtyNodes.push_back(v);
+   }
+
+   vector<ArbitrageCycle> detectChanged() {
+       if (!potentialValid) return detectAll();
+       int n = graph.size();
+       vector<ArbitrageCycle> cycles;
+       set<vector<int>> seen;
+       vector<int> pred(n, -1), hops(n, 0);
+       vector<double> predCost(n, 0.0);
+       vector<char> inQueue(n, 0), blocked(n, 0);
+       deque<int> q;
+       for (int v : dirtyNodes) {
+           if (!inQueue[v]) { inQueue[v] = 1; q.push_back(v); }
+       }
+       dirtyNodes.clear();
+       while (!q.empty()) {
+           int u = q.front(); q.pop_front();
+           inQueue[u] = 0;
+           if (blocked[u]) continue;
+           for (int e = graph.offsets[u]; e < graph.offsets[u + 1]; e++) {
+               int v = graph.targets[e];
+               double cand = potential[u] + cost[e];
+               if (blocked[v] || cand >= potential[v] - RATE_EPSILON) continue;
+               potential[v] = cand; pred[v] = u; predCost[v] = cost[e];
+               hops[v] = hops[u] + 1;
+               if (hops[v] >= n) {
+                   // v sits behind a cycle; report it and stop relaxing through it
+                   size_t before = cycles.size();
+                   extractCycle(v, pred, predCost, seen, cycles);
+                   blocked[v] = 1;
+                   for (size_t c = before; c < cycles.size(); c++) {
+                       for (auto& name : cycles[c].currencies) blocked[graph.idOf(name)] = 1;
+                   }
+                   continue;
+               }
+               if (!inQueue[v]) { inQueue[v] = 1; q.push_back(v); }
+           }
+       }
+       potentialValid = cycles.empty();
+       return cycles;
+   }
+};
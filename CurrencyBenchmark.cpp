@@ -0,0 +1,153 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <queue>
+#include <deque>
+#include <set>
+#include <string>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <stdexcept>
+#include <random>
+#include <chrono>
+#include <cstdio>
+#include "Currency.h"
+
+// Both converters define CurrencyConverter & co. at file scope; give each its own namespace.
+// The headers above are already included, so the nested includes are no-ops (Currency.h is shared by both).
+namespace anyPath {
+#include "Currency1.cpp"
+}
+namespace bestPath {
+#include "Currency2.cpp"
+}
+using namespace std;
+
+
+/*
+-------------------------------------------------------
+SEARCH MODE BENCHMARK
+-------------------------------------------------------
+Compares nodes visited and latency per query of
+   BFS / bidirectional BFS / BFS within maxHops      (Currency1)
+   Dijkstra / bidirectional / Bellman–Ford maxHops   (Currency2)
+on synthetic scale-free (Barabási–Albert) rate graphs.
+Rates come from hidden per-asset prices, so every path
+gives the same conversion and results can be
+cross-checked.
+Build: g++ -std=c++17 -O2 -pthread CurrencyBenchmark.cpp
+*/
+
+// Barabási–Albert: each new asset links to `m` existing assets picked proportionally to degree
+vector<vector<string>> scaleFreeRates(int n, int m, mt19937& rng) {
+   uniform_real_distribution<double> price(0.01, 100.0);
+   vector<double> value(n);
+   for (auto& v : value) v = price(rng);
+   vector<int> endpoints;                               // every edge endpoint once → degree-weighted pick
+   vector<vector<string>> rates;
+   char buf[32];
+   auto addRate = [&](int u, int v) {
+       snprintf(buf, sizeof(buf), "%.17g", value[u] / value[v]);
+       rates.push_back({"A" + to_string(u), "A" + to_string(v), buf});
+       endpoints.push_back(u);
+       endpoints.push_back(v);
+   };
+   for (int u = 1; u <= m && u < n; u++) addRate(u, 0); // small seed star
+   for (int u = m + 1; u < n; u++) {
+       unordered_set<int> picked;
+       while ((int)picked.size() < m) picked.insert(endpoints[rng() % endpoints.size()]);
+       for (int v : picked) addRate(u, v);
+   }
+   return rates;
+}
+
+struct ModeResult {
+   string name;
+   double totalMicros = 0;
+   long long totalVisited = 0;
+   int found = 0;
+};
+
+template <typename Query>
+void runMode(ModeResult& r, const vector<pair<string, string>>& queries, Query query) {
+   for (auto& [from, to] : queries) {
+       auto start = chrono::steady_clock::now();
+       auto [rate, visited] = query(from, to);
+       r.totalMicros += chrono::duration<double, micro>(chrono::steady_clock::now() - start).count();
+       r.totalVisited += visited;
+       if (rate > 0) r.found++;
+   }
+}
+
+void printResults(const vector<ModeResult>& results, int queryCount) {
+   cout << left << setw(28) << "  mode" << right << setw(14) << "avg visited"
+        << setw(14) << "avg us" << setw(10) << "found" << "\n";
+   for (auto& r : results) {
+       cout << left << setw(28) << ("  " + r.name) << right << setw(14) << fixed << setprecision(1)
+            << (double)r.totalVisited / queryCount << setw(14) << r.totalMicros / queryCount
+            << setw(10) << r.found << "\n";
+   }
+}
+
+int main(int argc, char** argv) {
+   int maxHops = 4;
+   int queryCount = 200;
+   vector<int> sizes = {5000, 50000};
+   if (argc > 1) sizes = {atoi(argv[1])};
+
+   for (int n : sizes) {
+       mt19937 rng(42);
+       auto rates = scaleFreeRates(n, 2, rng);
+       vector<pair<string, string>> queries;
+       for (int i = 0; i < queryCount; i++) {
+           queries.push_back({"A" + to_string(rng() % n), "A" + to_string(rng() % n)});
+       }
+       cout << "===== scale-free graph: " << n << " assets, " << rates.size() << " rates =====\n";
+
+       anyPath::CurrencyConverter c1(rates);
+       ModeResult bfs{"BFS"}, biBfs{"bidirectional BFS"}, hopBfs{"BFS maxHops=" + to_string(maxHops)};
+       runMode(bfs, queries, [&](const string& a, const string& b) {
+           double r = c1.getConversionRate(a, b); return make_pair(r, c1.lastVisitedCount());
+       });
+       runMode(biBfs, queries, [&](const string& a, const string& b) {
+           double r = c1.getConversionRateBidirectional(a, b); return make_pair(r, c1.lastVisitedCount());
+       });
+       runMode(hopBfs, queries, [&](const string& a, const string& b) {
+           double r = c1.getConversionRateWithinHops(a, b, maxHops); return make_pair(r, c1.lastVisitedCount());
+       });
+       cout << "Currency1 (any path)\n";
+       printResults({bfs, biBfs, hopBfs}, queryCount);
+
+       bestPath::CurrencyConverter c2(rates);
+       ModeResult dij{"Dijkstra"}, biDij{"bidirectional Dijkstra"}, hopBf{"Bellman-Ford maxHops=" + to_string(maxHops)};
+       runMode(dij, queries, [&](const string& a, const string& b) {
+           double r = c2.getMaxConversionRate(a, b); return make_pair(r, c2.lastVisitedCount());
+       });
+       runMode(biDij, queries, [&](const string& a, const string& b) {
+           double r = c2.getMaxConversionRateBidirectional(a, b); return make_pair(r, c2.lastVisitedCount());
+       });
+       runMode(hopBf, queries, [&](const string& a, const string& b) {
+           double r = c2.getMaxConversionRateWithinHops(a, b, maxHops); return make_pair(r, c2.lastVisitedCount());
+       });
+       cout << "Currency2 (best rate)\n";
+       printResults({dij, biDij, hopBf}, queryCount);
+
+       // Cross-check: consistent prices mean every mode must agree wherever it finds a path
+       int mismatches = 0;
+       for (auto& [a, b] : queries) {
+           double base = c1.getConversionRate(a, b);
+           for (double other : {c1.getConversionRateBidirectional(a, b), c2.getMaxConversionRate(a, b),
+                                c2.getMaxConversionRateBidirectional(a, b)}) {
+               if (abs(other - base) > 1e-6 * abs(base)) mismatches++;
+           }
+       }
+       cout << "cross-check mismatches: " << mismatches << "\n\n";
+   }
+   return 0;
+}
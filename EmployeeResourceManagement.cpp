@@ -4,59 +4,1160 @@
 #include <vector>          // vector
 #include <string>          // string
 #include <optional>        // optional (C++17+)
+#include <cstdint>         // uint8_t, uint64_t
+#include <algorithm>       // lower_bound, set_intersection, set_union, remove_if
+#include <array>           // array
+#include <iterator>        // back_inserter
+#include <atomic>          // atomic, atomic_thread_fence
+#include <memory>          // unique_ptr
+#include <mutex>           // unique_lock
+#include <shared_mutex>    // shared_mutex, shared_lock
+#include <thread>          // this_thread::yield, this_thread::get_id
+#include <future>          // async, future
+#include <chrono>          // steady_clock
+#include <type_traits>     // is_integral
+#include <stdexcept>       // runtime_error, logic_error
+#include <cstring>         // memcmp, memcpy
+#include <cstdio>          // rename
+#include <fcntl.h>         // open
+#include <sys/mman.h>      // mmap
+#include <sys/stat.h>      // fstat
+#include <unistd.h>        // ftruncate, fsync, close
 using namespace std; // use std namespace
 // Enum representing different access types
 enum class AccessType { READ, WRITE, ADMIN }; // strongly typed access permissions
+const int ACCESS_TYPE_COUNT = 3; // number of AccessType values
+// AccessType -> bit in a permission mask
+inline uint8_t accessBit(AccessType type) { return (uint8_t)(1u << (int)type); } // READ=1, WRITE=2, ADMIN=4
+// printable name of an access type
+string accessTypeToString(AccessType type) {
+    switch (type) { // one name per enum value
+        case AccessType::READ: return "READ";
+        case AccessType::WRITE: return "WRITE";
+        case AccessType::ADMIN: return "ADMIN";
+    }
+    return "UNKNOWN"; // unreachable for valid values
+}
+//============================== COMPRESSED BITMAP ====================================================
+// Roaring-style set of 32-bit ids: ids are grouped by their high 16 bits into containers;
+// a container keeps the low 16 bits as a sorted uint16 array while sparse (<= 4096 ids)
+// and as a 65536-bit bitset once dense
+// AND / OR run container by container; bitset pairs are plain 64-bit word loops the compiler vectorizes
+class RoaringBitmap {
+private:
+    static const uint32_t ARRAY_MAX = 4096; // beyond this an 8 KB bitset is smaller than the array
+    static const int WORDS = 1024; // 65536 bits per bitset
+    struct Container {
+        vector<uint16_t> values; // sorted low halves (array container)
+        vector<uint64_t> words; // bitset container; empty for array containers
+        uint32_t cardinality = 0; // ids in this container
+        bool isBitset() const { return !words.empty(); }
+        bool contains(uint16_t low) const {
+            if (isBitset()) return words[low >> 6] >> (low & 63) & 1; // bit test
+            return binary_search(values.begin(), values.end(), low); // sorted array
+        }
+        void toBitset() {
+            words.assign(WORDS, 0); // all clear
+            for (uint16_t low : values) words[low >> 6] |= 1ULL << (low & 63); // copy ids
+            vector<uint16_t>().swap(values); // release array
+        }
+        void toArray() {
+            values.clear(); // collect set bits
+            for (int w = 0; w < WORDS; w++)
+                for (uint64_t bits = words[w]; bits; bits &= bits - 1)
+                    values.push_back((uint16_t)(w * 64 + __builtin_ctzll(bits)));
+            vector<uint64_t>().swap(words); // release bitset
+        }
+        // true if low was not there yet; O(1) for bitsets, O(ARRAY_MAX) worst case for arrays
+        bool add(uint16_t low) {
+            if (!isBitset()) {
+                auto it = lower_bound(values.begin(), values.end(), low); // insert position
+                if (it != values.end() && *it == low) return false; // already present
+                if (cardinality < ARRAY_MAX) { values.insert(it, low); cardinality++; return true; }
+                toBitset(); // array is full: switch representation
+            }
+            uint64_t &word = words[low >> 6];
+            uint64_t bit = 1ULL << (low & 63);
+            if (word & bit) return false; // already present
+            word |= bit;
+            cardinality++;
+            return true;
+        }
+        // true if low was there; bitsets shrink back to arrays at ARRAY_MAX / 2,
+        // so alternating add / remove at the boundary does not convert every time
+        bool remove(uint16_t low) {
+            if (!isBitset()) {
+                auto it = lower_bound(values.begin(), values.end(), low);
+                if (it == values.end() || *it != low) return false; // not present
+                values.erase(it);
+                cardinality--;
+                return true;
+            }
+            uint64_t &word = words[low >> 6];
+            uint64_t bit = 1ULL << (low & 63);
+            if (!(word & bit)) return false; // not present
+            word &= ~bit;
+            if (--cardinality <= ARRAY_MAX / 2) toArray(); // sparse again
+            return true;
+        }
+        // bitset result back to an array when it ended up sparse
+        void normalize() {
+            if (isBitset() && cardinality <= ARRAY_MAX) toArray();
+            else if (!isBitset() && cardinality > ARRAY_MAX) toBitset();
+        }
+        static uint32_t popcount(const vector<uint64_t>& words) {
+            uint32_t total = 0;
+            for (uint64_t word : words) total += __builtin_popcountll(word);
+            return total;
+        }
+        static Container intersect(const Container& a, const Container& b) {
+            Container result;
+            if (a.isBitset() && b.isBitset()) { // word-wise AND
+                result.words.resize(WORDS);
+                for (int w = 0; w < WORDS; w++) result.words[w] = a.words[w] & b.words[w];
+                result.cardinality = popcount(result.words);
+                result.normalize();
+            } else if (a.isBitset() || b.isBitset()) { // filter the array by the bitset
+                const Container &bits = a.isBitset() ? a : b, &list = a.isBitset() ? b : a;
+                for (uint16_t low : list.values)
+                    if (bits.contains(low)) result.values.push_back(low);
+                result.cardinality = result.values.size();
+            } else { // sorted merge
+                set_intersection(a.values.begin(), a.values.end(), b.values.begin(), b.values.end(),
+                                 back_inserter(result.values));
+                result.cardinality = result.values.size();
+            }
+            return result;
+        }
+        static Container unite(const Container& a, const Container& b) {
+            Container result;
+            if (a.isBitset() && b.isBitset()) { // word-wise OR
+                result.words.resize(WORDS);
+                for (int w = 0; w < WORDS; w++) result.words[w] = a.words[w] | b.words[w];
+                result.cardinality = popcount(result.words);
+            } else if (a.isBitset() || b.isBitset()) { // set the array's bits in a copy of the bitset
+                const Container &bits = a.isBitset() ? a : b, &list = a.isBitset() ? b : a;
+                result.words = bits.words;
+                for (uint16_t low : list.values) result.words[low >> 6] |= 1ULL << (low & 63);
+                result.cardinality = popcount(result.words);
+            } else { // sorted merge
+                set_union(a.values.begin(), a.values.end(), b.values.begin(), b.values.end(),
+                          back_inserter(result.values));
+                result.cardinality = result.values.size();
+                result.normalize();
+            }
+            return result;
+        }
+    };
+    vector<uint16_t> highs; // sorted high halves that have a container
+    vector<Container> containers; // parallel to highs
+    size_t locate(uint16_t high) const { return lower_bound(highs.begin(), highs.end(), high) - highs.begin(); }
+public:
+    // true if id was not in the set; O(1) amortized (containers are few and bounded in size)
+    bool add(uint32_t id) {
+        uint16_t high = id >> 16;
+        size_t i = locate(high); // container position
+        if (i == highs.size() || highs[i] != high) { // first id with these high bits
+            highs.insert(highs.begin() + i, high);
+            containers.insert(containers.begin() + i, Container());
+        }
+        return containers[i].add((uint16_t)id);
+    }
+    // true if id was in the set
+    bool remove(uint32_t id) {
+        uint16_t high = id >> 16;
+        size_t i = locate(high);
+        if (i == highs.size() || highs[i] != high || !containers[i].remove((uint16_t)id)) return false;
+        if (containers[i].cardinality == 0) { // drop empty container
+            highs.erase(highs.begin() + i);
+            containers.erase(containers.begin() + i);
+        }
+        return true;
+    }
+    bool contains(uint32_t id) const {
+        size_t i = locate(id >> 16);
+        return i < highs.size() && highs[i] == (id >> 16) && containers[i].contains((uint16_t)id);
+    }
+    uint64_t cardinality() const {
+        uint64_t total = 0;
+        for (auto &c : containers) total += c.cardinality;
+        return total;
+    }
+    bool empty() const { return containers.empty(); }
+    // a AND b: only containers present in both are visited
+    static RoaringBitmap intersect(const RoaringBitmap& a, const RoaringBitmap& b) {
+        RoaringBitmap result;
+        for (size_t i = 0, j = 0; i < a.highs.size() && j < b.highs.size(); ) {
+            if (a.highs[i] < b.highs[j]) i++;
+            else if (a.highs[i] > b.highs[j]) j++;
+            else {
+                Container c = Container::intersect(a.containers[i], b.containers[j]);
+                if (c.cardinality) { result.highs.push_back(a.highs[i]); result.containers.push_back(move(c)); }
+                i++, j++;
+            }
+        }
+        return result;
+    }
+    // a OR b
+    static RoaringBitmap unite(const RoaringBitmap& a, const RoaringBitmap& b) {
+        RoaringBitmap result;
+        size_t i = 0, j = 0;
+        while (i < a.highs.size() || j < b.highs.size()) {
+            if (j == b.highs.size() || (i < a.highs.size() && a.highs[i] < b.highs[j])) {
+                result.highs.push_back(a.highs[i]); result.containers.push_back(a.containers[i++]);
+            } else if (i == a.highs.size() || b.highs[j] < a.highs[i]) {
+                result.highs.push_back(b.highs[j]); result.containers.push_back(b.containers[j++]);
+            } else {
+                result.highs.push_back(a.highs[i]);
+                result.containers.push_back(Container::unite(a.containers[i++], b.containers[j++]));
+            }
+        }
+        return result;
+    }
+    // calls f(id) in ascending order
+    template <typename F> void forEach(F f) const {
+        for (size_t i = 0; i < highs.size(); i++) {
+            uint32_t base = (uint32_t)highs[i] << 16;
+            const Container &c = containers[i];
+            if (!c.isBitset()) { for (uint16_t low : c.values) f(base | low); continue; }
+            for (int w = 0; w < WORDS; w++)
+                for (uint64_t bits = c.words[w]; bits; bits &= bits - 1)
+                    f(base | (uint32_t)(w * 64 + __builtin_ctzll(bits)));
+        }
+    }
+};
+//============================== FLAT ACCESS TABLE ====================================================
+// open-addressing table: 64-bit key -> integral Value (0 = absent); AccessTable maps
+// (employee_id, resource_id) -> uint8 bitmask of AccessType
+// keys are spread over 64 shards; each shard is a linear-probing power-of-two array (max load 0.7,
+// 16-byte slots for uint8 values, backward-shift deletion so there are no tombstones)
+// concurrency: get() is lock-free from any thread; update() must be serialized by the caller.
+// every shard has a seqlock: a writer makes its sequence odd, edits, makes it even again;
+// a reader retries when the sequence was odd or moved, so it never sees half of an update
+// (e.g. a multi-bit revoke, or a backward shift in progress). Readers write nothing shared,
+// so checks scale with cores. Slots are relaxed atomics: plain loads / stores on x86.
+// Arrays outgrown by a shard are kept until the table dies, since a reader may still be
+// probing one; growth is geometric, so that costs at most the size of the live arrays.
+template <typename Value> class FlatTable {
+private:
+    static_assert(is_integral<Value>::value, "values are bit patterns");
+    static const int SHARD_BITS = 6; // 64 shards
+    struct Slot { // one (employee, resource) entry
+        atomic<uint64_t> key{0};
+        atomic<Value> value{0};
+        atomic<bool> used{false};
+    };
+    struct Slots { // one shard array
+        size_t capacity; // power of two
+        unique_ptr<Slot[]> slot;
+        explicit Slots(size_t n) : capacity(n), slot(new Slot[n]) {}
+    };
+    struct alignas(64) Shard { // own cache line: writers on one shard do not disturb readers of others
+        atomic<uint64_t> sequence{0}; // odd while a writer is inside
+        atomic<Slots*> table{nullptr}; // current array
+        size_t count = 0; // used slots (writer only)
+        vector<unique_ptr<Slots>> arrays; // current + outgrown arrays (writer only)
+    };
+    Shard shards[1 << SHARD_BITS];
+    // splitmix64 finalizer: spreads sequential ids over the table
+    static uint64_t hash(uint64_t key) {
+        key ^= key >> 30; key *= 0xbf58476d1ce4e5b9ULL;
+        key ^= key >> 27; key *= 0x94d049bb133111ebULL;
+        return key ^ (key >> 31);
+    }
+    Shard& shardOf(uint64_t h) { return shards[h >> (64 - SHARD_BITS)]; } // top bits pick the shard
+    const Shard& shardOf(uint64_t h) const { return shards[h >> (64 - SHARD_BITS)]; }
+    // slot holding key, or the free slot where it would go (writer side)
+    static size_t probe(const Slots* t, uint64_t key, uint64_t h) {
+        size_t m = t->capacity - 1;
+        size_t i = h & m; // home slot from the low bits
+        while (t->slot[i].used.load(memory_order_relaxed) && t->slot[i].key.load(memory_order_relaxed) != key)
+            i = (i + 1) & m; // linear probing
+        return i;
+    }
+    static void copySlot(Slot& to, const Slot& from) {
+        to.key.store(from.key.load(memory_order_relaxed), memory_order_relaxed);
+        to.value.store(from.value.load(memory_order_relaxed), memory_order_relaxed);
+        to.used.store(from.used.load(memory_order_relaxed), memory_order_relaxed);
+    }
+    // builds a doubled array for shard s; not visible to readers until published
+    static Slots* grown(Shard& s) {
+        Slots* old = s.table.load(memory_order_relaxed);
+        s.arrays.push_back(make_unique<Slots>(old ? old->capacity * 2 : 16));
+        Slots* fresh = s.arrays.back().get();
+        if (old)
+            for (size_t i = 0; i < old->capacity; i++)
+                if (old->slot[i].used.load(memory_order_relaxed)) // keys are unique: first free slot
+                    copySlot(fresh->slot[probe(fresh, old->slot[i].key.load(memory_order_relaxed),
+                                               hash(old->slot[i].key.load(memory_order_relaxed)))], old->slot[i]);
+        return fresh;
+    }
+    // removes slot i by shifting the rest of its probe chain back
+    static void eraseAt(Slots* t, size_t i) {
+        size_t m = t->capacity - 1;
+        size_t hole = i; // slot to refill
+        for (size_t j = (i + 1) & m; t->slot[j].used.load(memory_order_relaxed); j = (j + 1) & m) {
+            size_t want = hash(t->slot[j].key.load(memory_order_relaxed)) & m; // where slot j would like to live
+            // slot j may move into hole iff hole lies cyclically in [want, j)
+            if (((j - want) & m) >= ((j - hole) & m)) {
+                copySlot(t->slot[hole], t->slot[j]); // shift back
+                hole = j;
+            }
+        }
+        t->slot[hole].used.store(false, memory_order_relaxed); // chain end is free now
+    }
+    static void beginWrite(Shard& s) {
+        s.sequence.store(s.sequence.load(memory_order_relaxed) + 1, memory_order_relaxed); // odd: readers retry
+        atomic_thread_fence(memory_order_release); // sequence bump is visible before any slot edit
+    }
+    static void endWrite(Shard& s) {
+        s.sequence.store(s.sequence.load(memory_order_relaxed) + 1, memory_order_release); // even: edits published
+    }
+public:
+    // packs the pair into one 64-bit key
+    static uint64_t makeKey(int employee_id, int resource_id) {
+        return ((uint64_t)(uint32_t)employee_id << 32) | (uint32_t)resource_id;
+    }
+    static int employeeOf(uint64_t key) { return (int)(uint32_t)(key >> 32); } // key -> employee_id
+    static int resourceOf(uint64_t key) { return (int)(uint32_t)key; } // key -> resource_id
+    // value stored for key, 0 if absent; lock-free, safe against a concurrent update()
+    // Time: O(1) expected (retries only while a writer is inside the same shard)
+    Value get(uint64_t key) const {
+        uint64_t h = hash(key);
+        const Shard &s = shardOf(h);
+        while (true) {
+            uint64_t sequence = s.sequence.load(memory_order_acquire); // snapshot start
+            if (sequence & 1) { this_thread::yield(); continue; } // writer inside
+            Value value = 0;
+            if (const Slots* t = s.table.load(memory_order_acquire)) {
+                size_t m = t->capacity - 1;
+                for (size_t i = h & m, n = 0; n < t->capacity; i = (i + 1) & m, n++) { // bounded: array may be changing
+                    if (!t->slot[i].used.load(memory_order_relaxed)) break; // chain end: absent
+                    if (t->slot[i].key.load(memory_order_relaxed) == key) { value = t->slot[i].value.load(memory_order_relaxed); break; }
+                }
+            }
+            atomic_thread_fence(memory_order_acquire); // slot reads complete before the re-check
+            if (s.sequence.load(memory_order_relaxed) == sequence) return value; // nobody wrote meanwhile
+        }
+    }
+    // value = (value | setBits) & ~clearBits in one probe; entries whose value becomes 0 are removed
+    // returns the value before the update; callers must serialize update() calls
+    // Time: O(1) expected
+    Value update(uint64_t key, Value setBits, Value clearBits) {
+        uint64_t h = hash(key);
+        Shard &s = shardOf(h);
+        Slots* t = s.table.load(memory_order_relaxed);
+        size_t i = t ? probe(t, key, h) : 0; // one probe
+        bool found = t && t->slot[i].used.load(memory_order_relaxed);
+        Value before = found ? t->slot[i].value.load(memory_order_relaxed) : 0;
+        Value after = (before | setBits) & ~clearBits;
+        if (after == before) return before; // no-op: readers are not disturbed
+        if (!found && (s.count + 1) * 10 > (t ? t->capacity : 0) * 7) { // insert would pass load 0.7
+            t = grown(s); // built off to the side
+            i = probe(t, key, h);
+        }
+        beginWrite(s);
+        s.table.store(t, memory_order_release); // publish (no-op unless grown)
+        if (!found) { // claim free slot
+            t->slot[i].key.store(key, memory_order_relaxed);
+            t->slot[i].used.store(true, memory_order_relaxed);
+            s.count++;
+        }
+        t->slot[i].value.store(after, memory_order_relaxed); // all bits change at once
+        if (after == 0) { eraseAt(t, i); s.count--; } // cleanup empty entry
+        endWrite(s);
+        return before;
+    }
+    // replaces the value of key (0 erases it); same contract as update()
+    void set(uint64_t key, Value value) { update(key, value, (Value)~value); }
+    // number of stored keys (writer side)
+    size_t size() const {
+        size_t total = 0;
+        for (auto &s : shards) total += s.count;
+        return total;
+    }
+    // calls f(key, value) for every entry (writer side, or with writers stopped)
+    template <typename F> void forEach(F f) const {
+        for (auto &s : shards) {
+            const Slots* t = s.table.load(memory_order_acquire);
+            for (size_t i = 0; t && i < t->capacity; i++)
+                if (t->slot[i].used.load(memory_order_relaxed))
+                    f(t->slot[i].key.load(memory_order_relaxed), t->slot[i].value.load(memory_order_relaxed));
+        }
+    }
+};
+using AccessTable = FlatTable<uint8_t>; // (employee_id, resource_id) -> AccessType bitmask
+//============================== SNAPSHOT IMAGE =======================================================
+// immutable on-disk access store, mmapped and probed in place (no load step, so cold start is O(1))
+// layout (little endian, 8-byte aligned):
+//   header   : "EAMS", uint32 version (1), uint64 slot count of each table, uint64 membership and
+//              nesting pair counts, padding to 64 bytes
+//   tables   : direct grants, then group grants; each an open-addressing array of 16-byte slots
+//              {uint64 key, uint8 mask, padding} with the AccessTable hash and linear probing,
+//              mask 0 = empty slot, power-of-two size, load <= 0.7
+//   pairs    : memberships {int32 group, int32 employee}, then nestings {int32 parent, int32 child}
+class AccessImage {
+public:
+    enum Table { DIRECT = 0, GROUP = 1 }; // which grant table
+private:
+    struct Header {
+        char magic[4];
+        uint32_t version;
+        uint64_t capacity[2]; // slots per table
+        uint64_t memberships; // membership pairs
+        uint64_t nestings; // nesting pairs
+        uint64_t reserved[3]; // pads header to 64 bytes
+    };
+    struct Slot { uint64_t key; uint8_t mask; uint8_t padding[7]; };
+    static_assert(sizeof(Header) == 64 && sizeof(Slot) == 16, "image layout");
+    const char* data = nullptr; // mapped file
+    size_t length = 0;
+    const Slot* tables[2] = {nullptr, nullptr};
+    uint64_t capacity[2] = {0, 0};
+    const int32_t* pairs[2] = {nullptr, nullptr}; // memberships, nestings
+    uint64_t pairCount[2] = {0, 0};
+    // same finalizer as AccessTable, so both agree on home slots
+    static uint64_t hash(uint64_t key) {
+        key ^= key >> 30; key *= 0xbf58476d1ce4e5b9ULL;
+        key ^= key >> 27; key *= 0x94d049bb133111ebULL;
+        return key ^ (key >> 31);
+    }
+    static uint64_t capacityFor(uint64_t entries) { // smallest power of two with load <= 0.7
+        if (entries == 0) return 0;
+        uint64_t capacity = 16;
+        while (entries * 10 > capacity * 7) capacity *= 2;
+        return capacity;
+    }
+    AccessImage() = default;
+public:
+    ~AccessImage() { if (data) munmap((void*)data, length); }
+    AccessImage(const AccessImage&) = delete;
+    AccessImage& operator=(const AccessImage&) = delete;
+    // maps and validates an image; throws runtime_error on a missing or malformed file
+    // Time: O(1): pages are faulted in by the lookups that touch them
+    static unique_ptr<AccessImage> open(const string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) throw runtime_error("cannot open snapshot " + path);
+        struct stat info;
+        if (fstat(fd, &info) != 0) { close(fd); throw runtime_error("cannot stat snapshot " + path); }
+        unique_ptr<AccessImage> image(new AccessImage());
+        image->length = info.st_size;
+        if (image->length < sizeof(Header)) { close(fd); throw runtime_error("truncated snapshot " + path); }
+        void* mapped = mmap(nullptr, image->length, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd); // mapping stays valid
+        if (mapped == MAP_FAILED) throw runtime_error("cannot map snapshot " + path);
+        madvise(mapped, image->length, MADV_RANDOM); // lookups jump around: no read-ahead
+        image->data = (const char*)mapped;
+        const Header* header = (const Header*)image->data;
+        if (memcmp(header->magic, "EAMS", 4) != 0 || header->version != 1) throw runtime_error("not a snapshot: " + path);
+        uint64_t offset = sizeof(Header);
+        for (int t = 0; t < 2; t++) {
+            uint64_t capacity = header->capacity[t];
+            if (capacity & (capacity - 1)) throw runtime_error("corrupt snapshot " + path);
+            image->capacity[t] = capacity;
+            image->tables[t] = (const Slot*)(image->data + offset);
+            offset += capacity * sizeof(Slot);
+        }
+        image->pairCount[0] = header->memberships;
+        image->pairCount[1] = header->nestings;
+        for (int k = 0; k < 2; k++) {
+            image->pairs[k] = (const int32_t*)(image->data + offset);
+            offset += image->pairCount[k] * 2 * sizeof(int32_t);
+        }
+        if (offset != image->length) throw runtime_error("corrupt snapshot " + path);
+        return image;
+    }
+    // mask stored for key, 0 if absent; the image never changes, so any thread may call this
+    // Time: O(1) expected
+    uint8_t get(Table table, uint64_t key) const {
+        uint64_t n = capacity[table];
+        if (n == 0) return 0;
+        const Slot* slots = tables[table];
+        for (uint64_t i = hash(key) & (n - 1); slots[i].mask; i = (i + 1) & (n - 1))
+            if (slots[i].key == key) return slots[i].mask;
+        return 0; // reached an empty slot
+    }
+    // calls f(key, mask) for every entry of a table
+    template <typename F> void forEach(Table table, F f) const {
+        for (uint64_t i = 0; i < capacity[table]; i++)
+            if (tables[table][i].mask) f(tables[table][i].key, tables[table][i].mask);
+    }
+    // calls f(first, second) for every membership (group, employee) or nesting (parent, child) pair
+    template <typename F> void forEachPair(bool nestings, F f) const {
+        for (uint64_t i = 0; i < pairCount[nestings]; i++) f(pairs[nestings][2 * i], pairs[nestings][2 * i + 1]);
+    }
+    // writes an image: tables[t] = entries {key, mask != 0}; the file is built in place through a shared
+    // mapping (no second copy in memory), synced, then renamed over path so readers never see half a file
+    static void write(const string& path, const vector<pair<uint64_t, uint8_t>> (&entries)[2],
+                      const vector<pair<int, int>>& memberships, const vector<pair<int, int>>& nestings) {
+        Header header = {};
+        memcpy(header.magic, "EAMS", 4);
+        header.version = 1;
+        uint64_t size = sizeof(Header);
+        for (int t = 0; t < 2; t++) {
+            header.capacity[t] = capacityFor(entries[t].size());
+            size += header.capacity[t] * sizeof(Slot);
+        }
+        header.memberships = memberships.size();
+        header.nestings = nestings.size();
+        size += (memberships.size() + nestings.size()) * 2 * sizeof(int32_t);
+        string temp = path + ".tmp";
+        int fd = ::open(temp.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) throw runtime_error("cannot create snapshot " + temp);
+        if (ftruncate(fd, size) != 0) { close(fd); throw runtime_error("cannot size snapshot " + temp); } // zero filled
+        void* mapped = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (mapped == MAP_FAILED) { close(fd); throw runtime_error("cannot map snapshot " + temp); }
+        char* out = (char*)mapped;
+        memcpy(out, &header, sizeof(Header));
+        uint64_t offset = sizeof(Header);
+        for (int t = 0; t < 2; t++) {
+            Slot* slots = (Slot*)(out + offset);
+            uint64_t n = header.capacity[t];
+            for (auto &[key, mask] : entries[t]) { // empty slots are the zero fill
+                uint64_t i = hash(key) & (n - 1);
+                while (slots[i].mask) i = (i + 1) & (n - 1);
+                slots[i].key = key;
+                slots[i].mask = mask;
+            }
+            offset += n * sizeof(Slot);
+        }
+        for (auto *list : {&memberships, &nestings})
+            for (auto &[first, second] : *list) {
+                int32_t pair[2] = {first, second};
+                memcpy(out + offset, pair, sizeof(pair));
+                offset += sizeof(pair);
+            }
+        bool synced = msync(mapped, size, MS_SYNC) == 0 && fsync(fd) == 0;
+        munmap(mapped, size);
+        close(fd);
+        if (!synced || rename(temp.c_str(), path.c_str()) != 0) throw runtime_error("cannot write snapshot " + path);
+    }
+};
+//============================== LAYERED ACCESS TABLE =================================================
+// a mapped snapshot image (base) plus an in-memory AccessTable holding only the changes since (delta)
+// delta entries carry OVERRIDE, so "revoked since the snapshot" (OVERRIDE with no access bits)
+// is representable; a revoke that leaves nothing over an image without the key is simply erased
+// readers check delta first, then the image: compaction installs the new image before it drops
+// the delta entries it absorbed, so a reader never falls through to an image that lacks them
+// image probes are counted per phase (two-phase grace period): install() flips the phase and waits
+// for the probes counted in the old one, so once it returns the replaced image can be unmapped
+class LayeredAccessTable {
+private:
+    static const uint8_t OVERRIDE = 0x40; // delta entry present (access bits may be empty)
+    static const uint8_t VALUE_BITS = OVERRIDE - 1; // caller's bits (access bits and their expiry flags)
+    static const int STRIPES = 16; // reader counters are striped by thread, so readers rarely share a line
+    struct alignas(64) Stripe {
+        atomic<int64_t> readers[2] = {}; // image probes in flight, per phase
+    };
+    AccessTable delta; // changes since the image
+    atomic<const AccessImage*> image{nullptr}; // current base, may be null
+    AccessImage::Table table; // which table of the image
+    vector<uint64_t> pending; // sorted keys being folded into the next image (writer side)
+    atomic<int> phase{0}; // current grace period (0 or 1)
+    mutable Stripe stripes[STRIPES];
+    static int stripeOf() { // this thread's counter stripe
+        static thread_local int stripe = (int)(hash<thread::id>{}(this_thread::get_id()) % STRIPES);
+        return stripe;
+    }
+    bool drained(int p) const { // no probe counted in phase p is in flight
+        for (auto &stripe : stripes)
+            if (stripe.readers[p].load()) return false;
+        return true;
+    }
+public:
+    explicit LayeredAccessTable(AccessImage::Table table) : table(table) {}
+    // lock-free, like AccessTable::get; an image probe bumps this thread's reader stripe
+    uint8_t get(uint64_t key) const {
+        uint8_t d = delta.get(key); // newest layer first
+        if (d) return d & VALUE_BITS;
+        Stripe &stripe = stripes[stripeOf()];
+        int p = phase.load(); // seq_cst throughout: counted before the image is loaded, against install()
+        stripe.readers[p].fetch_add(1);
+        while (phase.load() != p) { // flipped meanwhile: count in the current phase instead
+            stripe.readers[p].fetch_sub(1);
+            p ^= 1;
+            stripe.readers[p].fetch_add(1);
+        }
+        const AccessImage* base = image.load();
+        uint8_t mask = base ? base->get(table, key) : 0;
+        stripe.readers[p].fetch_sub(1, memory_order_release); // done with base
+        return mask;
+    }
+    // same contract as AccessTable::update (serialized writers, returns the mask before)
+    uint8_t update(uint64_t key, uint8_t setBits, uint8_t clearBits) {
+        uint8_t before = get(key);
+        uint8_t after = (before | setBits) & ~clearBits & VALUE_BITS;
+        if (after == before) return before;
+        const AccessImage* base = image.load(memory_order_relaxed);
+        // tombstone only if the image has the key, or the image being built will (compaction in flight)
+        bool shadowed = (base && base->get(table, key)) || binary_search(pending.begin(), pending.end(), key);
+        uint8_t stored = (after || shadowed) ? (OVERRIDE | after) : 0;
+        delta.update(key, stored, (uint8_t)~stored); // one store replaces the whole entry
+        return before;
+    }
+    // merged view: f(key, mask) for every key with access (writer side)
+    template <typename F> void forEach(F f) const {
+        delta.forEach([&](uint64_t key, uint8_t d) { if (d & VALUE_BITS) f(key, d & VALUE_BITS); });
+        if (const AccessImage* base = image.load(memory_order_acquire))
+            base->forEach(table, [&](uint64_t key, uint8_t mask) { if (!delta.get(key)) f(key, mask); });
+    }
+    // delta entries {key, stored byte}, for compaction
+    vector<pair<uint64_t, uint8_t>> deltaEntries() const {
+        vector<pair<uint64_t, uint8_t>> entries;
+        delta.forEach([&](uint64_t key, uint8_t d) { entries.push_back({key, d}); });
+        return entries;
+    }
+    const AccessImage* base() const { return image.load(memory_order_acquire); }
+    bool empty() const { return delta.size() == 0 && !base(); } // no grants at all
+    // compaction cut: these keys will be in the next image, so revoking one must leave a tombstone
+    // until install(), even if the current image lacks it (else the new image would revive it)
+    void beginCompaction(const vector<pair<uint64_t, uint8_t>>& absorbed) {
+        pending.clear();
+        for (auto &entry : absorbed) pending.push_back(entry.first);
+        sort(pending.begin(), pending.end());
+    }
+    // makes next the base, then drops the absorbed delta entries that were not changed meanwhile,
+    // and the tombstones written during the compaction that next turned out not to need
+    // on return no reader is probing the replaced image any more (serialized writers, like update)
+    void install(const AccessImage* next, const vector<pair<uint64_t, uint8_t>>& absorbed) {
+        image.store(next); // first the image...
+        int old = phase.load();
+        phase.store(old ^ 1); // probes from now on count in the other phase and see next
+        while (!drained(old)) this_thread::yield(); // grace period: one probe per reader at most
+        for (auto &[key, d] : absorbed)
+            if (delta.get(key) == d) delta.update(key, 0, 0xFF); // ...then the delta entries it contains
+        for (uint64_t key : pending)
+            if (delta.get(key) == OVERRIDE && !(next && next->get(table, key))) delta.update(key, 0, 0xFF);
+        pending.clear();
+    }
+};
+//============================== EXPIRY TIMER WHEEL ===================================================
+// hierarchical timing wheel of grant expirations, 1 ms ticks: level L has 64 slots of 64^L ticks each,
+// so 6 levels reach ~2 years ahead (later deadlines park in the top level and are re-placed on the way)
+// schedule() is O(1); advance() touches only the slots the clock moves through, and each timer
+// cascades down at most once per level before it fires, so no pass ever scans all pending timers
+// timers are never cancelled: the owner checks a fired timer against its current deadline (lazy delete)
+class ExpiryWheel {
+public:
+    struct Timer {
+        uint64_t key; // (employee_id, resource_id)
+        int64_t deadline; // steady_clock ticks (duration::rep)
+        uint8_t type; // AccessType that expires
+    };
+private:
+    static const int LEVELS = 6;
+    static const int SLOT_BITS = 6; // 64 slots per level
+    static const int SLOTS = 1 << SLOT_BITS;
+    vector<Timer> slots[LEVELS][SLOTS];
+    int64_t now; // last processed tick: every timer due at or before it has fired
+    size_t pending = 0; // scheduled timers
+    static int64_t tickOf(int64_t deadline) { // first wheel tick at or after deadline
+        int64_t per = chrono::duration_cast<chrono::steady_clock::duration>(chrono::milliseconds(1)).count();
+        return deadline / per + (deadline % per > 0);
+    }
+    // slot for a timer due no earlier than tick `earliest`: the level of the highest base-64 digit
+    // where its tick differs from now (level 0 when due now)
+    void place(const Timer& timer, int64_t earliest) {
+        int64_t tick = max(tickOf(timer.deadline), earliest);
+        uint64_t differ = (uint64_t)(tick ^ now);
+        int level = differ ? (63 - __builtin_clzll(differ)) / SLOT_BITS : 0;
+        if (level >= LEVELS) level = LEVELS - 1; // beyond the wheel: re-placed when its top slot comes round
+        slots[level][(tick >> (level * SLOT_BITS)) & (SLOTS - 1)].push_back(timer);
+    }
+public:
+    explicit ExpiryWheel(int64_t startTick) : now(startTick) {}
+    static int64_t tickAt(chrono::steady_clock::time_point t) { // wall clock -> wheel tick (floor)
+        return chrono::floor<chrono::milliseconds>(t.time_since_epoch()).count();
+    }
+    // Time: O(1)
+    void schedule(const Timer& timer) {
+        place(timer, now + 1); // the current tick is done: overdue timers fire on the next
+        pending++;
+    }
+    size_t size() const { return pending; }
+    // moves the wheel to tick `to`, calling fire(timer) for every timer due by then
+    // Time: O(ticks moved + timers fired + timers cascaded); an empty wheel jumps straight to `to`
+    template <typename F> void advance(int64_t to, F fire) {
+        while (now < to) {
+            if (pending == 0) { now = to; break; } // nothing to wait for
+            now++;
+            // higher levels first: a slot whose span starts now moves its timers one level down (or fires them)
+            for (int level = LEVELS - 1; level >= 1; level--) {
+                if (now & ((1LL << (level * SLOT_BITS)) - 1)) continue; // not a boundary of this level
+                vector<Timer> moving;
+                moving.swap(slots[level][(now >> (level * SLOT_BITS)) & (SLOTS - 1)]);
+                for (auto &timer : moving) place(timer, now); // due now: level 0, fired below
+            }
+            vector<Timer> due;
+            due.swap(slots[0][now & (SLOTS - 1)]);
+            pending -= due.size();
+            for (auto &timer : due) fire(timer);
+        }
+    }
+};
 //============================== ACCESS MANAGEMENT SYSTEM =============================================
+// concurrent mode (constructor flag): grant / revoke are serialized by a writer lock,
+// has_access / retrieve_access never lock (seqlocked AccessTable), and the index queries
+// (retrieve_resources, reverse index) take the lock shared; effective checks are lock-free on a cache
+// hit, a miss computes under the shared lock and publishes with one cache store (see inherited_mask)
+// persistence: grants live in a mapped snapshot image plus an in-memory delta (LayeredAccessTable);
+// load_snapshot serves checks straight from the image, compact_snapshot folds the delta into a new one
+// expiring grants: bit (type + 3) of a mask flags an access with a deadline (kept in expiry_at);
+// checks consult the deadline only when that flag is set, and an ExpiryWheel reclaims them;
+// index queries filter out expired grants the wheel has not reclaimed yet
 class EmployeeAccessManagementSystem { // main system managing employee-resource access
 private:
-    unordered_map<int, unordered_map<int, unordered_set<AccessType>>> access_store; //employee_id -> resource_id -> set of access types
+    static const uint8_t ACCESS_BITS = (1u << ACCESS_TYPE_COUNT) - 1; // low bits: access held
+    bool concurrent; // lock writers / index readers?
+    mutable shared_mutex index_lock; // writers exclusive, index queries shared (concurrent mode only)
+    LayeredAccessTable access_store{AccessImage::DIRECT}; // (employee_id, resource_id) -> AccessType bitmask
+    unique_ptr<AccessImage> current_image; // base of both layered tables, may be null; replaced ones are unmapped
+    mutex compaction_lock; // one compaction at a time
+    // indexes are rebuilt lazily after load_snapshot, so a cold start does not scan the image
+    mutable atomic<bool> indexes_stale{false};
+    mutable unordered_map<int, RoaringBitmap> resources_of; // employee_id -> resources with any access
+    mutable unordered_map<int, array<RoaringBitmap, ACCESS_TYPE_COUNT>> holders_of; // resource_id -> employees per access type
+    FlatTable<int64_t> expiry_at[ACCESS_TYPE_COUNT]; // per type: (employee_id, resource_id) -> steady_clock deadline
+    ExpiryWheel expiry_wheel{ExpiryWheel::tickAt(chrono::steady_clock::now())}; // pending expirations
+    // flag bit: this access type of the entry has a deadline
+    static uint8_t expiringBit(AccessType type) { return (uint8_t)(accessBit(type) << ACCESS_TYPE_COUNT); }
+    static int64_t clock_now() { return chrono::steady_clock::now().time_since_epoch().count(); }
+    // access bits of an entry minus those whose deadline has passed (expired grants vanish before the
+    // wheel reclaims them); entries without expiring grants cost one probe, as before
+    uint8_t live_mask(uint64_t key) const {
+        uint8_t mask = access_store.get(key);
+        uint8_t expiring = mask >> ACCESS_TYPE_COUNT; // types with a deadline
+        if (expiring) {
+            int64_t now = clock_now();
+            for (int type = 0; type < ACCESS_TYPE_COUNT; type++)
+                if ((expiring >> type & 1) && expiry_at[type].get(key) <= now) mask &= ~(1u << type); // expired
+        }
+        return mask & ACCESS_BITS;
+    }
+    // brings both indexes in step with a mask change of one (employee, resource) entry
+    // Time: O(1) amortized
+    void reindex(int employee_id, int resource_id, uint8_t before, uint8_t after) const {
+        if (before == after) return; // nothing changed
+        if (!before) resources_of[employee_id].add(resource_id); // first access on this resource
+        else if (!after) { // last access gone
+            auto it = resources_of.find(employee_id);
+            it->second.remove(resource_id);
+            if (it->second.empty()) resources_of.erase(it); // cleanup empty employee
+        }
+        auto &holders = holders_of[resource_id]; // per-type employee sets
+        for (int type = 0; type < ACCESS_TYPE_COUNT; type++) {
+            uint8_t bit = 1u << type;
+            if ((after & bit) && !(before & bit)) holders[type].add(employee_id); // bit granted
+            else if ((before & bit) && !(after & bit)) holders[type].remove(employee_id); // bit revoked
+        }
+        if (!after) { // drop resource entry once nobody holds anything on it
+            bool empty = true;
+            for (auto &h : holders) empty = empty && h.empty();
+            if (empty) holders_of.erase(resource_id);
+        }
+    }
+    // bitmap ids are the employee / resource ids reinterpreted as uint32
+    static vector<int> toIds(const RoaringBitmap& bitmap) {
+        vector<int> ids;
+        bitmap.forEach([&](uint32_t id) { ids.push_back((int)id); });
+        return ids;
+    }
+    // the indexes keep an expired grant until expire_grants() reclaims it: index queries drop such ids
+    // here; with no deadline pending the indexes are exact and the ids pass through untouched
+    // Time: O(ids) probes when expiring grants exist, O(1) otherwise
+    template <typename Live>
+    vector<int> liveOnly(vector<int> ids, Live live) const {
+        if (expiry_wheel.size() == 0) return ids; // nothing can have expired
+        ids.erase(remove_if(ids.begin(), ids.end(), [&](int id) { return !live(id); }), ids.end());
+        return ids;
+    }
+    const RoaringBitmap* holders(int resource_id, AccessType access_type) const {
+        auto it = holders_of.find(resource_id);
+        return it == holders_of.end() ? nullptr : &it->second[(int)access_type];
+    }
+    //------------------------------ GROUPS / ROLES ---------------------------------------------------
+    // a group (or role) holds grants of its own; members and members of nested subgroups inherit them
+    // storage is the policy itself: one entry per group grant, membership edge and subgroup edge
+    // inherited masks are cached per (employee, resource) on first check; changes invalidate only
+    // the affected members (and, for grants, only the affected resource); the cache is the only
+    // state an effective check writes, so those checks are non-const in both modes
+    static const uint8_t CACHED = 0x80; // cache entry present (so "inherits nothing" is cached too)
+    LayeredAccessTable group_grants{AccessImage::GROUP}; // (group_id, resource_id) -> AccessType bitmask
+    unordered_map<int, unordered_set<int>> group_members; // group_id -> direct employee members
+    unordered_map<int, unordered_set<int>> member_of; // employee_id -> groups joined directly
+    unordered_map<int, unordered_set<int>> subgroups; // group_id -> nested groups
+    unordered_map<int, unordered_set<int>> parent_groups; // group_id -> groups it is nested in
+    AccessTable effective_cache; // (employee_id, resource_id) -> CACHED | inherited mask
+    unordered_map<int, unordered_set<int>> cached_resources; // employee_id -> resources with a cache entry
+    mutex cache_fill_lock; // serializes cache fills among readers (writers exclude them via index_lock)
+    // every employee inheriting from group_id: members of it and of all nested subgroups
+    // Time: O(size of the subtree)
+    vector<int> members_below(int group_id) const {
+        unordered_set<int> seen_groups = {group_id}, seen_members;
+        vector<int> stack = {group_id}, result;
+        while (!stack.empty()) { // iterative walk down the nesting
+            int g = stack.back(); stack.pop_back();
+            if (auto it = group_members.find(g); it != group_members.end())
+                for (int e : it->second) if (seen_members.insert(e).second) result.push_back(e);
+            if (auto it = subgroups.find(g); it != subgroups.end())
+                for (int child : it->second) if (seen_groups.insert(child).second) stack.push_back(child);
+        }
+        return result;
+    }
+    // groups an employee inherits from (direct groups and everything they are nested in)
+    // Time: O(groups reached); read-only, so misses of different readers walk in parallel
+    vector<int> effective_groups_of(int employee_id) const {
+        unordered_set<int> seen;
+        vector<int> stack, result;
+        if (auto it = member_of.find(employee_id); it != member_of.end())
+            for (int g : it->second) if (seen.insert(g).second) stack.push_back(g);
+        while (!stack.empty()) { // iterative walk up the nesting
+            int g = stack.back(); stack.pop_back();
+            result.push_back(g);
+            if (auto it = parent_groups.find(g); it != parent_groups.end())
+                for (int parent : it->second) if (seen.insert(parent).second) stack.push_back(parent);
+        }
+        return result;
+    }
+    // drops one cached (employee, resource) entry
+    void invalidate(int employee_id, int resource_id) {
+        effective_cache.update(AccessTable::makeKey(employee_id, resource_id), 0, 0xFF);
+    }
+    // drops everything cached for an employee (membership / nesting changed)
+    void invalidate(int employee_id) {
+        auto it = cached_resources.find(employee_id);
+        if (it == cached_resources.end()) return;
+        for (int resource_id : it->second) invalidate(employee_id, resource_id);
+        cached_resources.erase(it);
+    }
+    // true if descendant is group_id itself or nested somewhere below it
+    bool nests(int group_id, int descendant) const {
+        unordered_set<int> seen = {group_id};
+        vector<int> stack = {group_id};
+        while (!stack.empty()) {
+            int g = stack.back(); stack.pop_back();
+            if (g == descendant) return true;
+            if (auto it = subgroups.find(g); it != subgroups.end())
+                for (int child : it->second) if (seen.insert(child).second) stack.push_back(child);
+        }
+        return false;
+    }
+    // inherited mask: cache hit is one lock-free probe; a miss ORs the employee's groups' grants
+    // under the shared lock (writers wait, other readers do not), then publishes it with a single
+    // effective_cache store under cache_fill_lock, the only part serialized between readers
+    // Time: O(1) expected on a hit, O(groups reached) on a miss
+    uint8_t inherited_mask(int employee_id, int resource_id) {
+        uint64_t key = AccessTable::makeKey(employee_id, resource_id);
+        uint8_t cached = effective_cache.get(key); // lock-free probe
+        if (cached) return cached & ~CACHED;
+        auto guard = read_guard(); // groups and grants stay put while we compute
+        uint8_t mask = 0;
+        for (int g : effective_groups_of(employee_id)) mask |= group_grants.get(AccessTable::makeKey(g, resource_id));
+        unique_lock<mutex> fill = concurrent ? unique_lock<mutex>(cache_fill_lock) : unique_lock<mutex>();
+        effective_cache.update(key, CACHED | mask, 0); // remember (a racing fill stored the same mask)
+        cached_resources[employee_id].insert(resource_id);
+        return mask;
+    }
+    unique_lock<shared_mutex> write_guard() const { // exclusive in concurrent mode, nothing otherwise
+        return concurrent ? unique_lock<shared_mutex>(index_lock) : unique_lock<shared_mutex>();
+    }
+    shared_lock<shared_mutex> read_guard() const { // shared in concurrent mode, nothing otherwise
+        return concurrent ? shared_lock<shared_mutex>(index_lock) : shared_lock<shared_mutex>();
+    }
+    // rebuilds both reverse indexes from the grants after a snapshot load (first index query pays)
+    // Time: O(grants)
+    void ensure_indexes() const {
+        if (!indexes_stale.load(memory_order_acquire)) return; // common case
+        auto guard = write_guard(); // rebuild once, exclusively
+        if (!indexes_stale.load(memory_order_relaxed)) return;
+        resources_of.clear();
+        holders_of.clear();
+        access_store.forEach([&](uint64_t key, uint8_t mask) {
+            reindex(AccessTable::employeeOf(key), AccessTable::resourceOf(key), 0, mask & ACCESS_BITS);
+        });
+        indexes_stale.store(false, memory_order_release);
+    }
 public:
-    void grant_access(int employee_id, int resource_id, AccessType access_type) {
-        access_store[employee_id][resource_id].insert(access_type); // grant permission
+    explicit EmployeeAccessManagementSystem(bool concurrent = false) : concurrent(concurrent) {}
+    // expires_at: the grant stops counting at that instant and expire_grants() reclaims it later;
+    // re-granting an expiring access keeps the later deadline, granting without one makes it permanent
+    // Time: O(1) expected: one probe + bit set (+ one deadline store and one wheel insert if expiring)
+    void grant_access(int employee_id, int resource_id, AccessType access_type,
+                      optional<chrono::steady_clock::time_point> expires_at = nullopt) {
+        auto guard = write_guard(); // serialize writers
+        uint64_t key = AccessTable::makeKey(employee_id, resource_id);
+        uint8_t bit = accessBit(access_type), expiring = expiringBit(access_type);
+        uint8_t before = access_store.get(key);
+        uint8_t after = (before | bit) & ~expiring; // grant permission (permanent)
+        if (expires_at.has_value()) {
+            if ((before & bit) && !(before & expiring)) return; // already permanent: nothing to expire
+            auto &expiry = expiry_at[(int)access_type];
+            int64_t deadline = expires_at->time_since_epoch().count();
+            int64_t current = (before & expiring) ? expiry.get(key) : 0; // live deadline, if any
+            if (deadline > current) { // otherwise the pending timer already covers the later deadline
+                expiry.set(key, deadline); // deadline before flag: a reader seeing the flag finds it
+                expiry_wheel.schedule({key, deadline, (uint8_t)access_type});
+            }
+            after |= expiring;
+        }
+        access_store.update(key, after, (uint8_t)~after); // bits and flags change in one store
+        if (!indexes_stale.load(memory_order_relaxed)) // stale indexes are rebuilt from the grants anyway
+            reindex(employee_id, resource_id, before & ACCESS_BITS, after & ACCESS_BITS); // keep reverse indexes in step
     }
+    // Time: O(1) expected: one probe + bit clear, plus O(1) amortized index updates
     void revoke_access(int employee_id, int resource_id, optional<AccessType> access_type) {
-        // check if employee exists
-        if (!access_store.count(employee_id)) return; // nothing to revoke
-        // check if resource exists
-        if (!access_store[employee_id].count(resource_id)) return; // nothing to revoke
-        // if no access type provided → remove all access for resource
-        if (!access_type.has_value()) { // revoke all access
-            access_store[employee_id].erase(resource_id); // remove resource entry
-        }
-        else { // revoke specific access type
-            access_store[employee_id][resource_id].erase(access_type.value()); // remove specific permission
-            // if no access types remain, remove resource entry
-            if (access_store[employee_id][resource_id].empty())
-                access_store[employee_id].erase(resource_id); // cleanup empty resource
-        }
-        // if employee has no resources left, remove employee entry
-        if (access_store[employee_id].empty())
-            access_store.erase(employee_id); // cleanup empty employee
-    }
-    // Return all access types an employee has for a resource
-    // Time: O(k) where k = number of access types (max 3)
+        auto guard = write_guard(); // serialize writers
+        // if no access type provided → remove all access for resource (all bits vanish in one store)
+        // an expiring grant's deadline stays until its timer fires, which then only drops the deadline
+        uint8_t clear = access_type.has_value() ? (uint8_t)(accessBit(access_type.value()) | expiringBit(access_type.value())) : 0xFF; // bit(s) to clear
+        // if no access types remain, the table drops the resource entry
+        uint8_t before = access_store.update(AccessTable::makeKey(employee_id, resource_id), 0, clear);
+        if (!indexes_stale.load(memory_order_relaxed)) // stale indexes are rebuilt from the grants anyway
+            reindex(employee_id, resource_id, before & ACCESS_BITS, before & ~clear & ACCESS_BITS); // keep reverse indexes in step
+    }
+    // true if employee has access_type on resource (and it has not expired); lock-free in concurrent mode
+    // Time: O(1) expected: one probe + bit test (+ one deadline probe for an expiring grant)
+    bool has_access(int employee_id, int resource_id, AccessType access_type) const {
+        uint64_t key = AccessTable::makeKey(employee_id, resource_id);
+        uint8_t mask = access_store.get(key);
+        if (!(mask & accessBit(access_type))) return false; // never granted (or reclaimed)
+        if (!(mask & expiringBit(access_type))) return true; // permanent grant
+        return expiry_at[(int)access_type].get(key) > clock_now(); // before its deadline
+    }
+    // Return all access types an employee has for a resource; lock-free in concurrent mode
+    // Time: O(1) expected: one probe, then at most 3 bits
     vector<AccessType> retrieve_access(int employee_id, int resource_id) {
         vector<AccessType> result; // store access types
-        // check employee exists
-        if (!access_store.count(employee_id)) return result; // return empty list
-        // check resource exists
-        if (!access_store[employee_id].count(resource_id)) return result; // return empty list
-        // copy access types from set to vector
-        for (auto &type : access_store[employee_id][resource_id])
-            result.push_back(type); // add to result
+        uint8_t mask = live_mask(AccessTable::makeKey(employee_id, resource_id)); // one probe, expired grants dropped
+        for (int type = 0; type < ACCESS_TYPE_COUNT; type++) // bits -> access types
+            if (mask & (1u << type)) result.push_back((AccessType)type); // add to result
         return result; // return all access types
     }
-    // Return all resources an employee can access
+    // Return all resources an employee can access (ascending by id as uint32)
     // Time: O(r) where r = number of resources for employee
     vector<int> retrieve_resources(int employee_id) {
-        vector<int> result; // store resource ids
-        // check employee exists
-        if (!access_store.count(employee_id)) return result; // return empty list
-        // collect all resource ids
-        for (auto &p : access_store[employee_id])
-            result.push_back(p.first); // add resource id
-        return result; // return resources
+        ensure_indexes(); // after a snapshot load
+        auto guard = read_guard(); // consistent with writers in concurrent mode
+        auto it = resources_of.find(employee_id); // check employee exists
+        if (it == resources_of.end()) return {}; // return empty list
+        return liveOnly(toIds(it->second), [&](int resource_id) { // return resources
+            return live_mask(AccessTable::makeKey(employee_id, resource_id)) != 0;
+        });
+    }
+    //------------------------------ REVERSE INDEX QUERIES -------------------------------------------
+    // employees holding access_type on resource_id ("who has ADMIN on X")
+    // Time: O(result)
+    vector<int> employees_with_access(int resource_id, AccessType access_type) const {
+        ensure_indexes(); // after a snapshot load
+        auto guard = read_guard(); // consistent with writers in concurrent mode
+        const RoaringBitmap *h = holders(resource_id, access_type);
+        if (!h) return {};
+        return liveOnly(toIds(*h), [&](int employee_id) { return has_access(employee_id, resource_id, access_type); });
+    }
+    // employees holding access_type on every resource in resource_ids (bitmap AND, smallest set first)
+    vector<int> employees_with_access_on_all(const vector<int>& resource_ids, AccessType access_type) const {
+        ensure_indexes(); // after a snapshot load
+        auto guard = read_guard(); // consistent with writers in concurrent mode
+        vector<const RoaringBitmap*> sets;
+        for (int resource_id : resource_ids) {
+            const RoaringBitmap *h = holders(resource_id, access_type);
+            if (!h) return {}; // someone's set is empty
+            sets.push_back(h);
+        }
+        if (sets.empty()) return {};
+        sort(sets.begin(), sets.end(), [](auto a, auto b) { return a->cardinality() < b->cardinality(); });
+        RoaringBitmap result = *sets[0];
+        for (size_t i = 1; i < sets.size() && !result.empty(); i++) result = RoaringBitmap::intersect(result, *sets[i]);
+        return liveOnly(toIds(result), [&](int employee_id) {
+            for (int resource_id : resource_ids) if (!has_access(employee_id, resource_id, access_type)) return false;
+            return true;
+        });
+    }
+    // employees holding access_type on at least one resource in resource_ids (bitmap OR)
+    vector<int> employees_with_access_on_any(const vector<int>& resource_ids, AccessType access_type) const {
+        ensure_indexes(); // after a snapshot load
+        auto guard = read_guard(); // consistent with writers in concurrent mode
+        RoaringBitmap result;
+        for (int resource_id : resource_ids)
+            if (const RoaringBitmap *h = holders(resource_id, access_type)) result = RoaringBitmap::unite(result, *h);
+        return liveOnly(toIds(result), [&](int employee_id) {
+            for (int resource_id : resource_ids) if (has_access(employee_id, resource_id, access_type)) return true;
+            return false;
+        });
+    }
+    // resources both employees can access in some way (bitmap AND)
+    vector<int> shared_resources(int employee_a, int employee_b) const {
+        ensure_indexes(); // after a snapshot load
+        auto guard = read_guard(); // consistent with writers in concurrent mode
+        auto a = resources_of.find(employee_a), b = resources_of.find(employee_b);
+        if (a == resources_of.end() || b == resources_of.end()) return {};
+        return liveOnly(toIds(RoaringBitmap::intersect(a->second, b->second)), [&](int resource_id) {
+            return live_mask(AccessTable::makeKey(employee_a, resource_id)) && live_mask(AccessTable::makeKey(employee_b, resource_id));
+        });
+    }
+    //------------------------------ GROUPS / ROLES ---------------------------------------------------
+    // grant to a group: inherited by every member below it
+    // Time: O(1) + O(members below group) cache invalidations
+    void grant_group_access(int group_id, int resource_id, AccessType access_type) {
+        auto guard = write_guard(); // serialize writers
+        uint8_t before = group_grants.update(AccessTable::makeKey(group_id, resource_id), accessBit(access_type), 0);
+        if (before & accessBit(access_type)) return; // already granted
+        for (int e : members_below(group_id)) invalidate(e, resource_id); // only this resource changes
+    }
+    void revoke_group_access(int group_id, int resource_id, optional<AccessType> access_type) {
+        auto guard = write_guard(); // serialize writers
+        uint8_t clear = access_type.has_value() ? accessBit(access_type.value()) : 0xFF; // bit(s) to clear
+        uint8_t before = group_grants.update(AccessTable::makeKey(group_id, resource_id), 0, clear);
+        if (!(before & clear)) return; // nothing revoked
+        for (int e : members_below(group_id)) invalidate(e, resource_id); // only this resource changes
+    }
+    void add_member(int group_id, int employee_id) {
+        auto guard = write_guard(); // serialize writers
+        if (!group_members[group_id].insert(employee_id).second) return; // already a member
+        member_of[employee_id].insert(group_id);
+        invalidate(employee_id); // only this employee's inheritance changes
+    }
+    void remove_member(int group_id, int employee_id) {
+        auto guard = write_guard(); // serialize writers
+        auto it = group_members.find(group_id);
+        if (it == group_members.end() || !it->second.erase(employee_id)) return; // not a member
+        if (it->second.empty()) group_members.erase(it);
+        auto mine = member_of.find(employee_id);
+        mine->second.erase(group_id);
+        if (mine->second.empty()) member_of.erase(mine);
+        invalidate(employee_id);
+    }
+    // nests child inside parent; false (and no change) if that would create a cycle
+    bool add_subgroup(int parent_id, int child_id) {
+        auto guard = write_guard(); // serialize writers
+        if (nests(child_id, parent_id)) return false; // parent already below child (or equal)
+        if (!subgroups[parent_id].insert(child_id).second) return true; // already nested
+        parent_groups[child_id].insert(parent_id);
+        for (int e : members_below(child_id)) invalidate(e); // child's members gain parent's grants
+        return true;
+    }
+    void remove_subgroup(int parent_id, int child_id) {
+        auto guard = write_guard(); // serialize writers
+        auto it = subgroups.find(parent_id);
+        if (it == subgroups.end() || !it->second.erase(child_id)) return; // not nested
+        if (it->second.empty()) subgroups.erase(it);
+        auto up = parent_groups.find(child_id);
+        up->second.erase(parent_id);
+        if (up->second.empty()) parent_groups.erase(up);
+        for (int e : members_below(child_id)) invalidate(e); // child's members lose parent's grants
+    }
+    // direct or inherited access; O(1) expected once the (employee, resource) pair is cached
+    bool has_effective_access(int employee_id, int resource_id, AccessType access_type) {
+        if (has_access(employee_id, resource_id, access_type)) return true; // direct grant
+        return inherited_mask(employee_id, resource_id) & accessBit(access_type);
+    }
+    vector<AccessType> retrieve_effective_access(int employee_id, int resource_id) {
+        uint8_t mask = live_mask(AccessTable::makeKey(employee_id, resource_id)) | inherited_mask(employee_id, resource_id);
+        vector<AccessType> result;
+        for (int type = 0; type < ACCESS_TYPE_COUNT; type++) // bits -> access types
+            if (mask & (1u << type)) result.push_back((AccessType)type);
+        return result;
+    }
+    //------------------------------ EXPIRING GRANTS --------------------------------------------------
+    // revokes grants whose deadline has passed (checks already ignore them); call it from a periodic
+    // timer instead of scanning all grants: cost is O(ms since the last call + grants expiring)
+    // returns the number of grants revoked
+    size_t expire_grants(chrono::steady_clock::time_point now = chrono::steady_clock::now()) {
+        auto guard = write_guard(); // serialize writers
+        size_t revoked = 0;
+        expiry_wheel.advance(ExpiryWheel::tickAt(now), [&](const ExpiryWheel::Timer& timer) {
+            auto &expiry = expiry_at[timer.type];
+            if (expiry.get(timer.key) != timer.deadline) return; // re-granted later: a newer timer owns it
+            uint8_t expiring = expiringBit((AccessType)timer.type);
+            uint8_t before = access_store.get(timer.key);
+            if (before & expiring) { // still an expiring grant (not revoked or made permanent meanwhile)
+                uint8_t clear = expiring | accessBit((AccessType)timer.type);
+                access_store.update(timer.key, 0, clear); // access before deadline: readers never see the flag without it
+                if (!indexes_stale.load(memory_order_relaxed))
+                    reindex(AccessTable::employeeOf(timer.key), AccessTable::resourceOf(timer.key),
+                            before & ACCESS_BITS, before & ~clear & ACCESS_BITS);
+                revoked++;
+            }
+            expiry.set(timer.key, 0); // deadline no longer referenced
+        });
+        return revoked;
+    }
+    //------------------------------ SNAPSHOTS ---------------------------------------------------------
+    // startup: maps a snapshot and serves checks from it right away; only the (small) group
+    // structure is read, reverse indexes are rebuilt on first use; throws logic_error unless empty
+    // Time: O(memberships + nestings)
+    void load_snapshot(const string& path) {
+        unique_ptr<AccessImage> image = AccessImage::open(path); // validates header and size
+        auto guard = write_guard();
+        if (!access_store.empty() || !group_grants.empty() || !group_members.empty() || !subgroups.empty())
+            throw logic_error("load_snapshot needs an empty access system");
+        for (auto& [employee_id, resources] : cached_resources) // checks made before the load cached
+            for (int resource_id : resources) invalidate(employee_id, resource_id); // "inherits nothing"
+        cached_resources.clear();
+        image->forEachPair(false, [&](int group_id, int employee_id) {
+            group_members[group_id].insert(employee_id);
+            member_of[employee_id].insert(group_id);
+        });
+        image->forEachPair(true, [&](int parent_id, int child_id) {
+            subgroups[parent_id].insert(child_id);
+            parent_groups[child_id].insert(parent_id);
+        });
+        access_store.install(image.get(), {});
+        group_grants.install(image.get(), {});
+        current_image = move(image); // the system was empty: nothing to replace
+        indexes_stale.store(true, memory_order_release);
+    }
+    // writes image + delta as a new snapshot at path and switches to it; the writer lock is held only
+    // to copy the delta / group structure and to install the result, the merge and write run unlocked
+    // expiring grants are not written (they stay in the delta), so a restart drops them: fail closed
+    // Time: O(grants) for the write, O(delta) under the lock
+    void compact_snapshot(const string& path) {
+        lock_guard<mutex> one(compaction_lock); // one compaction at a time
+        vector<pair<uint64_t, uint8_t>> absorbed[2]; // delta copies, as stored
+        vector<pair<int, int>> memberships, nestings;
+        const AccessImage* base;
+        {
+            auto guard = write_guard(); // consistent cut
+            absorbed[0] = access_store.deltaEntries();
+            absorbed[1] = group_grants.deltaEntries();
+            access_store.beginCompaction(absorbed[0]); // revokes during the merge keep tombstones
+            group_grants.beginCompaction(absorbed[1]);
+            base = access_store.base(); // both tables share one image
+            for (auto &[group_id, members] : group_members)
+                for (int employee_id : members) memberships.push_back({group_id, employee_id});
+            for (auto &[parent_id, children] : subgroups)
+                for (int child_id : children) nestings.push_back({parent_id, child_id});
+        }
+        vector<pair<uint64_t, uint8_t>> entries[2]; // merged tables
+        for (int t = 0; t < 2; t++) {
+            vector<uint64_t> overridden; // sorted delta keys
+            for (auto &entry : absorbed[t]) overridden.push_back(entry.first);
+            sort(overridden.begin(), overridden.end());
+            if (base)
+                base->forEach((AccessImage::Table)t, [&](uint64_t key, uint8_t mask) {
+                    if (!binary_search(overridden.begin(), overridden.end(), key)) entries[t].push_back({key, mask}); // unchanged since the image
+                });
+            for (auto &[key, stored] : absorbed[t]) {
+                uint8_t permanent = stored & ACCESS_BITS & ~(stored >> ACCESS_TYPE_COUNT); // expiring grants stay in memory
+                if (permanent) entries[t].push_back({key, permanent});
+            }
+        }
+        AccessImage::write(path, entries, memberships, nestings);
+        unique_ptr<AccessImage> next = AccessImage::open(path);
+        // entries holding expiring grants are only partly in the image: they stay in the delta
+        uint8_t expiring = ACCESS_BITS << ACCESS_TYPE_COUNT;
+        absorbed[0].erase(remove_if(absorbed[0].begin(), absorbed[0].end(),
+                                    [&](auto &entry) { return entry.second & expiring; }), absorbed[0].end());
+        auto guard = write_guard();
+        access_store.install(next.get(), absorbed[0]); // entries changed meanwhile stay in the delta
+        group_grants.install(next.get(), absorbed[1]);
+        current_image = move(next); // no reader is left on the old image: unmapped here (its file too, if replaced)
+    }
+    // compact_snapshot on a background thread; writers may keep going meanwhile (concurrent mode only,
+    // since without it nothing serializes the caller's writes against the compaction)
+    future<void> compact_snapshot_async(const string& path) {
+        if (!concurrent) throw logic_error("background compaction needs concurrent mode");
+        return async(launch::async, [this, path] { compact_snapshot(path); });
     }
 };
 
@@ -82,5 +1183,21 @@ int main() { // program entry point
     system.revoke_access(1, 101, AccessType::WRITE); // revoke WRITE from employee 1 on resource 101
     // revoke all access
     system.revoke_access(1, 102, nullopt); // revoke all access on resource 102
+    // groups: employee 3 inherits WRITE on 101 through team 10 nested in department 20
+    system.add_member(10, 3); // employee 3 joins team 10
+    system.add_subgroup(20, 10); // team 10 is part of department 20
+    system.grant_group_access(20, 101, AccessType::WRITE); // department-wide grant
+    cout << "Employee 3 can WRITE Resource 101: " << system.has_effective_access(3, 101, AccessType::WRITE) << endl;
+    // temporary access: employee 4 may READ resource 103 for 50 ms
+    system.grant_access(4, 103, AccessType::READ, chrono::steady_clock::now() + chrono::milliseconds(50));
+    cout << "Employee 4 can READ Resource 103: " << system.has_access(4, 103, AccessType::READ) << endl;
+    this_thread::sleep_for(chrono::milliseconds(60)); // deadline passes: invisible before any reclaim
+    cout << "Employee 4 can READ Resource 103 after expiry: " << system.has_access(4, 103, AccessType::READ) << endl;
+    cout << "Expired grants reclaimed: " << system.expire_grants() << endl; // timer wheel tick
+    // reverse index: who can read resource 101
+    auto readers = system.employees_with_access(101, AccessType::READ); // bitmap lookup
+    cout << "READ on Resource 101: "; // print label
+    for (auto &e : readers) cout << e << " "; // print employee ids
+    cout << endl; // newline
     return 0; // exit program
 }
@@ -1,6 +1,7 @@
 #include <iostream>
 #include <vector>
-#include <queue>
+#include <algorithm>
+#include "OrgTree.h"
 using namespace std;
 /*
 -------------------------------------------------------
@@ -9,24 +10,16 @@ Time Complexity: O(N)
 Space Complexity: O(N)
 -------------------------------------------------------
 */
-int getOrgHeight(int n, vector<int>& managers, vector<int>& reportees) {
-   vector<vector<int>> tree(n + 1);                     // adjacency list for tree
-   for (int i = 0; i < managers.size(); i++) {
-       tree[managers[i]].push_back(reportees[i]);       // build tree: manager -> reportee
-   }
-   queue<pair<int, int>> q;                             // {node, level}
-   q.push({1, 1});                                      // CEO = 1 at level 1
-   int maxHeight = 0;                                   // store max depth
-   while (!q.empty()) {
-       auto curr = q.front(); q.pop();                  // pop current node
-       int node = curr.first;                           // current employee
-       int level = curr.second;                         // current level
-       maxHeight = max(maxHeight, level);               // update max height
-       for (int child : tree[node]) {
-           q.push({child, level + 1});                  // push children with incremented level
-       }
-   }
-   return maxHeight;                                    // return final height
+int getOrgHeight(const OrgTree& tree, int threads = 1) {
+   auto height = runTreeDP<int>(tree, [](int, const int* children, int count) {
+       int maxChildHeight = 0;                          // track max height among children
+       for (int i = 0; i < count; i++) maxChildHeight = max(maxChildHeight, children[i]);
+       return maxChildHeight + 1;                       // height including current node
+   }, threads);                                         // parallel bottom-up engine (OrgTree.h)
+   return height[tree.root];                            // equals tree.height(), the BFS level count
+}
+int getOrgHeight(int n, vector<int>& managers, vector<int>& reportees, int threads = 1) {
+   return getOrgHeight(buildOrgTree(n, managers, reportees), threads); // CEO = 1 at level 1
 }
 /*
 -------------------------------------------------------
@@ -34,27 +27,25 @@ PART 2: Minimize CEO direct reports while keeping height ≤ h
 Time Complexity: O(N)
 Space Complexity: O(N)
 -------------------------------------------------------
+Subtree heights on the bottom-up engine (OrgTree.h):
+level by level from the deepest, no recursion. A
+detached subtree reports height 0 and every other
+node at least 1, so the cuts are the zero heights.
 */
-int dfs(int node, vector<vector<int>>& tree, int h, int& cuts) {
-   int maxChildHeight = 0;                              // track max height among children
-   for (int child : tree[node]) {
-       int childHeight = dfs(child, tree, h, cuts);     // recursively compute child height
-       maxChildHeight = max(maxChildHeight, childHeight); // update max height
-   }
-   if (maxChildHeight == h - 1) {                       // if adding this node makes height = h
-       cuts++;                                          // we cut here (attach to CEO)
-       return 0;                                        // reset height since detached subtree
-   }
-   return maxChildHeight + 1;                           // return height including current node
-}
-int minimizeCEOReports(int n, vector<int>& managers, vector<int>& reportees, int h) {
-   vector<vector<int>> tree(n + 1);                     // adjacency list
-   for (int i = 0; i < managers.size(); i++) {
-       tree[managers[i]].push_back(reportees[i]);       // build tree
-   }
+int countCuts(const OrgTree& tree, int h, int threads = 1) {
+   auto height = runTreeDP<int>(tree, [h](int, const int* children, int count) {
+       int maxChildHeight = 0;                          // track max height among children
+       for (int i = 0; i < count; i++) maxChildHeight = max(maxChildHeight, children[i]);
+       if (maxChildHeight == h - 1) return 0;           // cut here (attach to CEO): detached subtree
+       return maxChildHeight + 1;                       // height including current node
+   }, threads);
    int cuts = 0;                                        // number of nodes reattached to CEO
-   dfs(1, tree, h, cuts);                               // run DFS from CEO
-   return cuts;                                         // minimum extra direct reports to CEO
+   for (int node : tree.bfsOrder) cuts += height[node] == 0;
+   return cuts;
+}
+int minimizeCEOReports(int n, vector<int>& managers, vector<int>& reportees, int h, int threads = 1) {
+   OrgTree tree = buildOrgTree(n, managers, reportees); // CSR tree + BFS order
+   return countCuts(tree, h, threads);                  // minimum extra direct reports to CEO
 }
 /*
 -------------------------------------------------------
@@ -0,0 +1,195 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <type_traits>
+using namespace std;
+
+
+/*
+-------------------------------------------------------
+ORG TREE (CSR)
+-------------------------------------------------------
+Shared by OrgTree2.cpp and OrgHeirarchyMinReports.cpp.
+Employees are 1..n; children of v sit contiguously in
+   child[childStart[v] .. childStart[v + 1])
+so a pass over a level reads one flat array instead of
+chasing one heap vector per employee.
+bfsOrder lists the employees under root level by level
+(levelStart[d] .. levelStart[d + 1] is depth d). Every
+manager comes before its reportees, so walking it
+backwards is a bottom-up (post-)order: tree DPs become
+a single loop and cannot overflow the stack, whatever
+the depth of the hierarchy.
+Build Time Complexity: O(N)
+Space Complexity: O(N)
+*/
+struct OrgTree {
+   int n = 0;                                                // employees 1..n
+   int root = 1;                                             // CEO
+   vector<int> childStart;                                   // CSR offsets, size n + 2
+   vector<int> child;                                        // reportees grouped by manager
+   vector<int> parent;                                       // manager, -1 for root / unreachable
+   vector<int> depth;                                        // root = 0, -1 if not under root
+   vector<int> bfsOrder;                                     // employees under root, by level
+   vector<int> levelStart;                                   // bfsOrder offset of each depth, plus end
+   vector<int> bfsChildStart;                                // reportees of bfsOrder[i] are bfsOrder[bfsChildStart[i] ..
+                                                             //   bfsChildStart[i + 1]): contiguous in BFS order
+
+   int childCount(int node) const { return childStart[node + 1] - childStart[node]; }
+   const int* childBegin(int node) const { return child.data() + childStart[node]; }
+   const int* childEnd(int node) const { return child.data() + childStart[node + 1]; }
+   int height() const { return (int)levelStart.size() - 1; } // number of levels
+};
+
+
+// edges manager[i] → reportee[i]; reportees keep their input order
+inline OrgTree buildOrgTree(int n, const vector<int>& managers, const vector<int>& reportees, int root = 1) {
+   OrgTree tree;
+   tree.n = n;
+   tree.root = root;
+   tree.childStart.assign(n + 2, 0);
+   for (int m : managers) tree.childStart[m + 1]++;           // counting sort by manager
+   for (int v = 0; v <= n; v++) tree.childStart[v + 1] += tree.childStart[v];
+   tree.child.resize(managers.size());
+   tree.parent.assign(n + 1, -1);
+   vector<int> fill(tree.childStart.begin(), tree.childStart.end() - 1);
+   for (size_t i = 0; i < managers.size(); i++) {
+       tree.child[fill[managers[i]]++] = reportees[i];
+       tree.parent[reportees[i]] = managers[i];
+   }
+   tree.parent[root] = -1;
+
+   tree.depth.assign(n + 1, -1);                             // BFS, level by level
+   tree.bfsOrder.reserve(n);
+   tree.bfsOrder.push_back(root);
+   tree.depth[root] = 0;
+   tree.levelStart.push_back(0);
+   for (size_t i = 0; i < tree.bfsOrder.size(); i++) {
+       int node = tree.bfsOrder[i];
+       if (tree.depth[node] == (int)tree.levelStart.size()) tree.levelStart.push_back(i); // first of a new level
+       tree.bfsChildStart.push_back(tree.bfsOrder.size());  // its reportees are appended next
+       for (const int* c = tree.childBegin(node); c != tree.childEnd(node); c++) {
+           tree.depth[*c] = tree.depth[node] + 1;
+           tree.bfsOrder.push_back(*c);
+       }
+   }
+   tree.levelStart.push_back(tree.bfsOrder.size());
+   tree.bfsChildStart.push_back(tree.bfsOrder.size());
+   return tree;
+}
+
+
+// from buildTree-style adjacency lists (tree[manager] = reportees)
+inline OrgTree buildOrgTree(const vector<vector<int>>& adjacency, int root = 1) {
+   vector<int> managers, reportees;
+   for (int m = 0; m < (int)adjacency.size(); m++) {
+       for (int r : adjacency[m]) { managers.push_back(m); reportees.push_back(r); }
+   }
+   return buildOrgTree((int)adjacency.size() - 1, managers, reportees, root);
+}
+
+
+
+/*
+-------------------------------------------------------
+BOTTOM-UP TREE DP ENGINE
+-------------------------------------------------------
+state[v] = combine(v, children, k), where children
+points at the k states of v's reportees (contiguous,
+in input order). Levels run from the deepest up; a
+wide level is split into chunks that threads claim
+from a shared counter, and threads meet at a barrier
+before the level above starts. Runs of narrow levels
+go to one thread with no barriers in between, so a
+deep chain costs no more than the sequential loop.
+Each state depends only on its children, computed in
+a fixed order, so results do not depend on threads
+or scheduling. Returns states indexed by employee.
+Time Complexity: O(N) combine calls spread over the
+threads, plus one barrier per wide level
+Space Complexity: O(N)
+*/
+class LevelBarrier {                                         // reusable: everyone waits for the last
+   mutex lock;
+   condition_variable wake;
+   int parties, waiting = 0;
+   long long generation = 0;
+public:
+   explicit LevelBarrier(int parties) : parties(parties) {}
+   void arrive() {
+       unique_lock<mutex> guard(lock);
+       long long mine = generation;
+       if (++waiting == parties) {                           // last one in releases the rest
+           waiting = 0;
+           generation++;
+           wake.notify_all();
+       } else {
+           wake.wait(guard, [&] { return generation != mine; });
+       }
+   }
+};
+
+template <typename State, typename Combine>
+vector<State> runTreeDP(const OrgTree& tree, Combine combine, int threads = 1) {
+   static_assert(!is_same<State, bool>::value, "vector<bool> shares bytes between threads: use char");
+   const int CHUNK = 4096;                                   // positions per claimed chunk
+   const int PARALLEL_LEVEL = 4 * CHUNK;                     // narrower levels run on one thread
+   int count = tree.bfsOrder.size();
+   vector<State> at(count);                                  // state by BFS position
+   vector<State> result(tree.n + 1);
+   auto compute = [&](int from, int to) {                    // positions [from, to), deeper first
+       for (int i = to - 1; i >= from; i--) {
+           int first = tree.bfsChildStart[i];
+           at[i] = combine(tree.bfsOrder[i], at.data() + first, tree.bfsChildStart[i + 1] - first);
+       }
+   };
+   auto scatter = [&](int from, int to) {                    // BFS position → employee id
+       for (int i = from; i < to; i++) result[tree.bfsOrder[i]] = at[i];
+   };
+   threads = max(1, min(threads, count / CHUNK));            // no more threads than chunks
+   if (threads == 1) {
+       compute(0, count);                                    // plain bottom-up loop
+       scatter(0, count);
+       return result;
+   }
+
+   struct Step { int from, to; bool parallel; };             // positions [from, to)
+   vector<Step> steps;
+   for (int d = tree.height() - 1; d >= 0; d--) {            // deepest level first
+       int from = tree.levelStart[d], to = tree.levelStart[d + 1];
+       bool wide = to - from >= PARALLEL_LEVEL;
+       if (!wide && !steps.empty() && !steps.back().parallel) steps.back().from = from; // extend narrow run
+       else steps.push_back({from, to, wide});
+   }
+   steps.push_back({0, count, true});                        // scatter, after every level is done
+   unique_ptr<atomic<int>[]> nextChunk(new atomic<int>[steps.size()]);
+   for (size_t s = 0; s < steps.size(); s++) nextChunk[s] = 0;
+   LevelBarrier barrier(threads);
+
+   auto worker = [&](int id) {
+       for (size_t s = 0; s < steps.size(); s++) {
+           const Step& step = steps[s];
+           bool last = s + 1 == steps.size();
+           if (step.parallel) {
+               int chunks = (step.to - step.from + CHUNK - 1) / CHUNK;
+               for (int c; (c = nextChunk[s].fetch_add(1, memory_order_relaxed)) < chunks;) {
+                   int from = step.from + c * CHUNK, to = min(step.to, from + CHUNK);
+                   if (last) scatter(from, to); else compute(from, to);
+               }
+           } else if (id == 0) {
+               compute(step.from, step.to);                  // narrow levels: one thread, in order
+           }
+           if (!last) barrier.arrive();                      // level done before the one above
+       }
+   };
+   vector<thread> pool;
+   for (int t = 1; t < threads; t++) pool.emplace_back(worker, t);
+   worker(0);                                                // calling thread takes part
+   for (auto& t : pool) t.join();
+   return result;
+}
@@ -1,5 +1,7 @@
 #include <iostream>
 #include <vector>
+#include <utility>
+#include "OrgTree.h"
 using namespace std;
 
 
@@ -31,34 +33,35 @@ int getDirectReportees(int manager, vector<vector<int>>& tree) {
 /*
 -------------------------------------------------------
 PART 2: Lowest Common Manager (LCA)
-Time Complexity: O(N)
+Time Complexity: O(depth) per query, O(N) to build the OrgTree
 -------------------------------------------------------
+Climbs manager links instead of recursing over the
+subtree, so chain-like hierarchies cannot overflow the
+stack. Same answers as the subtree search: the common
+manager if both are under node, the one that is if
+only one is, -1 otherwise.
 */
-int findLCA(int node, int emp1, int emp2, vector<vector<int>>& tree) {
-
-
-   if (node == emp1 || node == emp2) return node;            // if match found
-
-
-   int foundCount = 0;                                       // count matches in subtree
-   int temp = -1;                                            // store candidate
-
-
-   for (int child : tree[node]) {
-       int res = findLCA(child, emp1, emp2, tree);           // DFS into subtree
-
-
-       if (res != -1) {                                      // if found in subtree
-           foundCount++;
-           temp = res;
-       }
+int findLCA(int node, int emp1, int emp2, const OrgTree& tree) {
+   auto under = [&](int emp) {                               // emp in node's subtree?
+       if (emp < 1 || emp > tree.n || tree.depth[emp] < 0 || tree.depth[node] < 0) return false;
+       while (tree.depth[emp] > tree.depth[node]) emp = tree.parent[emp]; // climb to node's level
+       return emp == node;
+   };
+   bool has1 = under(emp1), has2 = under(emp2);
+   if (!has1 || !has2) return has1 ? emp1 : has2 ? emp2 : -1; // at most one found
+
+
+   while (tree.depth[emp1] > tree.depth[emp2]) emp1 = tree.parent[emp1]; // equalize depths
+   while (tree.depth[emp2] > tree.depth[emp1]) emp2 = tree.parent[emp2];
+   while (emp1 != emp2) {                                    // climb together
+       emp1 = tree.parent[emp1];
+       emp2 = tree.parent[emp2];
    }
+   return emp1;
+}
 
-
-   if (foundCount >= 2) return node;                         // both found in different branches
-
-
-   return temp;                                              // propagate found node
+int findLCA(int node, int emp1, int emp2, vector<vector<int>>& tree) {
+   return findLCA(node, emp1, emp2, buildOrgTree(tree));     // adjacency-list callers
 }
 
 
@@ -67,38 +70,196 @@ int findLCA(int node, int emp1, int emp2, vector<vector<int>>& tree) {
 PART 3: Minimum Weight Independent Set (Tree DP)
 Time Complexity: O(N)
 -------------------------------------------------------
+One loop over the BFS order backwards: every child is
+finished before its manager, no recursion.
 */
 
 
 pair<long long, long long> dfsMinWeight(int node,
-                                       vector<vector<int>>& tree,
+                                       const OrgTree& tree,
                                        vector<int>& weight) {
 
 
-   long long include = weight[node];                         // include this node
-   long long exclude = 0;                                    // exclude this node
+   vector<int> scratch;                                      // BFS of node's subtree (root: precomputed)
+   if (node != tree.root) {
+       scratch.push_back(node);
+       for (size_t i = 0; i < scratch.size(); i++)
+           scratch.insert(scratch.end(), tree.childBegin(scratch[i]), tree.childEnd(scratch[i]));
+   }
+   const vector<int>& order = node == tree.root ? tree.bfsOrder : scratch;
 
 
-   for (int child : tree[node]) {
+   vector<long long> exclude(tree.n + 1, 0), include(tree.n + 1, 0);
+   for (int i = (int)order.size() - 1; i >= 0; i--) {       // children before managers
+       int v = order[i];
+       include[v] += weight[v];                              // include this node
+       if (v == node) break;                                 // subtree finished
+       int up = tree.parent[v];
+       include[up] += exclude[v];                            // include → child excluded
+       exclude[up] += min(exclude[v], include[v]);           // exclude → take best of child
+   }
 
 
-       auto childDP = dfsMinWeight(child, tree, weight);     // recurse on child
+   return {exclude[node], include[node]};                    // return both cases
+}
 
 
-       include += childDP.first;                             // include → child excluded
+pair<long long, long long> dfsMinWeight(int node,
+                                       vector<vector<int>>& tree,
+                                       vector<int>& weight) {
+   return dfsMinWeight(node, buildOrgTree(tree), weight);    // adjacency-list callers
+}
 
 
-       exclude += min(childDP.first, childDP.second);        // exclude → take best of child
-   }
+// same DP on the parallel engine (OrgTree.h): one level at a time, wide levels across threads
+long long getMinWeightSet(const OrgTree& tree, vector<int>& weight, int threads = 1) {
+   auto dp = runTreeDP<pair<long long, long long>>(tree,
+       [&](int node, const pair<long long, long long>* children, int count) {
+           long long include = weight[node];                 // include this node
+           long long exclude = 0;                            // exclude this node
+           for (int i = 0; i < count; i++) {
+               include += children[i].first;                 // include → child excluded
+               exclude += min(children[i].first, children[i].second); // exclude → take best of child
+           }
+           return make_pair(exclude, include);               // same layout as dfsMinWeight
+       }, threads);
+   auto res = dp[tree.root];                                 // CEO = tree.root
+   return min(res.first, res.second);                        // choose optimal
+}
 
+long long getMinWeightSet(vector<vector<int>>& tree, vector<int>& weight) {
+   return getMinWeightSet(buildOrgTree(tree), weight);       // assume CEO = 1
+}
 
-   return {exclude, include};                                // return both cases
+
+/*
+-------------------------------------------------------
+PART 4: LCA Index (preorder + sparse table RMQ)
+Build Time Complexity: O(N log N)
+Query Time Complexity: O(1)
+Space Complexity: O(N log N)
+-------------------------------------------------------
+Euler-tour RMQ over the preorder instead of the full
+2N-1 tour: for tin[a] < tin[b], the common manager is
+the parent with the smallest tin among the parents of
+the nodes at preorder positions tin[a]+1 .. tin[b].
+Half the table of the classic tour, same O(1) query.
+Built once from buildTree's adjacency; iterative, so
+deep chains cannot overflow the stack.
+*/
+struct LCAIndex {
+   vector<int> tin;                                          // preorder position, -1 = not under root
+   vector<int> order;                                        // preorder position → node
+   vector<int> parent;                                       // parent in the tree, -1 for root
+   vector<vector<int>> sparse;                               // sparse[k][i]: min-tin parent of order[i .. i+2^k)
+};
+
+LCAIndex buildLCAIndex(vector<vector<int>>& tree, int root = 1) {
+   int size = tree.size();
+   LCAIndex index;
+   index.tin.assign(size, -1);
+   index.parent.assign(size, -1);
+   vector<int> stack = {root};                               // explicit DFS stack
+   while (!stack.empty()) {
+       int node = stack.back(); stack.pop_back();
+       index.tin[node] = index.order.size();                 // preorder position
+       index.order.push_back(node);
+       for (int i = tree[node].size() - 1; i >= 0; i--) {    // reversed: children leave in list order
+           index.parent[tree[node][i]] = node;
+           stack.push_back(tree[node][i]);
+       }
+   }
+   int count = index.order.size();
+   auto shallower = [&](int a, int b) { return index.tin[a] < index.tin[b] ? a : b; };
+   index.sparse.push_back(vector<int>(count));
+   for (int i = 0; i < count; i++) {
+       int up = index.parent[index.order[i]];
+       index.sparse[0][i] = up < 0 ? index.order[i] : up;    // root never ends a query range
+   }
+   for (int k = 1; (1 << k) <= count; k++) {                 // doubling levels
+       auto& prev = index.sparse[k - 1];
+       vector<int> level(count - (1 << k) + 1);
+       for (int i = 0; i < (int)level.size(); i++) level[i] = shallower(prev[i], prev[i + (1 << (k - 1))]);
+       index.sparse.push_back(move(level));
+   }
+   return index;
 }
 
+int queryLCA(const LCAIndex& index, int emp1, int emp2) {
+   if (emp1 < 0 || emp2 < 0 || emp1 >= (int)index.tin.size() || emp2 >= (int)index.tin.size()) return -1;
+   int l = index.tin[emp1], r = index.tin[emp2];
+   if (l < 0 || r < 0) return -1;                            // someone is outside the org
+   if (l == r) return emp1;                                  // same employee
+   if (l > r) swap(l, r);
+   l++;                                                      // range of parents: (tin[a], tin[b]]
+   int k = 31 - __builtin_clz(r - l + 1);                    // two overlapping power-of-two blocks
+   int a = index.sparse[k][l], b = index.sparse[k][r - (1 << k) + 1];
+   return index.tin[a] < index.tin[b] ? a : b;               // shallower of the two
+}
 
-long long getMinWeightSet(vector<vector<int>>& tree, vector<int>& weight) {
-   auto res = dfsMinWeight(1, tree, weight);                 // assume CEO = 1
-   return min(res.first, res.second);                        // choose optimal
+
+/*
+-------------------------------------------------------
+PART 5: Batch LCA (Tarjan's offline algorithm)
+Time Complexity: O((N + Q) α(N))
+Space Complexity: O(N + Q)
+-------------------------------------------------------
+For millions of pairs at once: one DFS answers every
+query when its second endpoint finishes, with a
+union-find of finished subtrees. No per-query table
+lookups and no N log N index. Queries are bucketed
+per node in flat arrays; the DFS is iterative.
+Answer is -1 when an employee is not under root.
+*/
+vector<int> findLCABatch(vector<vector<int>>& tree, vector<pair<int, int>>& queries, int root = 1) {
+   int size = tree.size();
+   vector<int> answer(queries.size(), -1);
+   vector<int> start(size + 1, 0), bucket(2 * queries.size()); // queries per endpoint (CSR)
+   auto valid = [&](int node) { return node >= 0 && node < size; };
+   for (auto& [a, b] : queries) {
+       if (valid(a) && valid(b)) { start[a + 1]++; start[b + 1]++; }
+   }
+   for (int i = 0; i < size; i++) start[i + 1] += start[i];
+   vector<int> fill(start.begin(), start.end() - 1);
+   for (int q = 0; q < (int)queries.size(); q++) {
+       auto [a, b] = queries[q];
+       if (valid(a) && valid(b)) { bucket[fill[a]++] = q; bucket[fill[b]++] = q; }
+   }
+
+   vector<int> link(size), ancestor(size);                   // union-find over finished subtrees
+   vector<char> finished(size, 0);
+   for (int i = 0; i < size; i++) link[i] = i;
+   auto find = [&](int x) {
+       while (link[x] != x) { link[x] = link[link[x]]; x = link[x]; } // path halving
+       return x;
+   };
+
+   vector<pair<int, int>> stack = {{root, 0}};               // {node, next child index}
+   ancestor[root] = root;
+   while (!stack.empty()) {
+       auto& [node, next] = stack.back();
+       if (next < (int)tree[node].size()) {                  // descend into next child
+           int child = tree[node][next++];
+           ancestor[child] = child;
+           stack.push_back({child, 0});
+           continue;
+       }
+       finished[node] = 1;                                   // subtree done: answer its queries
+       for (int i = start[node]; i < start[node + 1]; i++) {
+           auto [a, b] = queries[bucket[i]];
+           int other = a == node ? b : a;
+           if (finished[other]) answer[bucket[i]] = ancestor[find(other)];
+       }
+       int done = node;
+       stack.pop_back();
+       if (!stack.empty()) {                                 // merge into parent's set
+           int up = stack.back().first;
+           int ru = find(up), rd = find(done);
+           link[rd] = ru;
+           ancestor[ru] = up;
+       }
+   }
+   return answer;
 }
 
 
@@ -118,6 +279,7 @@ int main() {
 
 
    vector<vector<int>> tree = buildTree(n, managers, reportees); // build tree
+   OrgTree org = buildOrgTree(n, managers, reportees);       // CSR + BFS order for the DPs
 
 
    // PART 1
@@ -127,7 +289,7 @@ int main() {
 
    // PART 2
    cout << "Common manager of 4 and 5: "
-        << findLCA(1, 4, 5, tree) << endl;
+        << findLCA(1, 4, 5, org) << endl;
 
 
    // PART 3
@@ -135,7 +297,21 @@ int main() {
 
 
    cout << "Minimum Weight Independent Set: "
-        << getMinWeightSet(tree, weight) << endl;
+        << getMinWeightSet(org, weight) << endl;
+
+
+   // PART 4
+   LCAIndex index = buildLCAIndex(tree);                     // built once, O(1) per query
+   cout << "Common manager of 4 and 7: "
+        << queryLCA(index, 4, 7) << endl;
+
+
+   // PART 5
+   vector<pair<int, int>> pairs = {{4, 5}, {4, 7}, {6, 7}, {2, 5}};
+   vector<int> managersOf = findLCABatch(tree, pairs);       // offline, one DFS
+   cout << "Batch common managers:";
+   for (int m : managersOf) cout << " " << m;
+   cout << endl;
 
 
    return 0;
@@ -0,0 +1,284 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <unordered_map>
+#include <queue>
+#include <deque>
+#include <array>
+#include <set>
+#include <map>
+#include <string>
+#include <tuple>
+#include <iterator>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <functional>
+#include <stdexcept>
+#include <random>
+#include <new>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include "Split.h"
+
+// Every settlement file defines its own Solution / main at file scope; give each its own namespace.
+// The headers above are already included, so the nested includes are no-ops (Split.h is shared by both).
+namespace greedy {
+#include "Split1.cpp"
+}
+namespace exact {
+#include "Split2.cpp"
+}
+namespace service {
+#include "TransactionSettlement.cpp"
+}
+using namespace std;
+
+
+/*
+-------------------------------------------------------
+SETTLEMENT SOLVER BENCHMARK
+-------------------------------------------------------
+Runs every settlement implementation on the same seeded
+ledgers and reports, per (generator, N, solver):
+   wall time, heap allocations, peak RSS, transfers
+Solvers:
+   Split1 greedy heaps                  (greedy::Solution)
+   Split2 subset DP / branch and bound / anytime
+                                        (exact::Solution)
+   settleBasic / settleOptimal / interned greedy
+                                        (service::SettlementService)
+Generators (N people, 3N transactions):
+   uniform    - payer and receiver uniform
+   power-law  - payers Zipf(1.2): a few people pay most bills
+   clustered  - groups of 4-6 people that only share
+                expenses among themselves
+Each measurement runs in a forked child, so peak RSS is
+per run and a solver that blows up is cut at TIME_LIMIT
+instead of taking the harness down. The last table lists,
+per generator and N, the fastest solver reaching the
+fewest transfers seen, marked "proved" when an exact
+solver confirmed that count is the minimum.
+Build: g++ -std=c++17 -O2 -pthread SettlementBenchmark.cpp
+*/
+
+// Heap allocations made by the current process (counted in the measured child only)
+atomic<long long> allocationCount{0};
+atomic<long long> allocationBytes{0};
+
+// noinline keeps GCC from pairing the inlined malloc/free with new/delete call sites
+__attribute__((noinline)) void* countedAllocate(size_t size) {
+   allocationCount.fetch_add(1, memory_order_relaxed);
+   allocationBytes.fetch_add(size, memory_order_relaxed);
+   if (void* p = malloc(size ? size : 1)) return p;
+   throw bad_alloc();
+}
+__attribute__((noinline)) void countedRelease(void* p) noexcept { free(p); }
+
+void* operator new(size_t size) { return countedAllocate(size); }
+void* operator new[](size_t size) { return countedAllocate(size); }
+void operator delete(void* p) noexcept { countedRelease(p); }
+void operator delete(void* p, size_t) noexcept { countedRelease(p); }
+void operator delete[](void* p) noexcept { countedRelease(p); }
+void operator delete[](void* p, size_t) noexcept { countedRelease(p); }
+
+const int TIME_LIMIT_SECONDS = 10;                        // child is killed past this
+const chrono::milliseconds SEARCH_BUDGET(1000);           // budget for branch and bound / anytime
+
+// {payer, receiver, amount}; amounts are whole units
+vector<array<int, 3>> generateLedger(const string& kind, int people, mt19937& rng) {
+   vector<array<int, 3>> ledger;
+   int count = 3 * people;
+   uniform_int_distribution<int> amount(1, 500);
+   uniform_int_distribution<int> anyone(0, people - 1);
+   if (kind == "uniform") {
+       for (int i = 0; i < count; i++) ledger.push_back({anyone(rng), anyone(rng), amount(rng)});
+   } else if (kind == "power-law") {
+       vector<double> weight(people);
+       for (int i = 0; i < people; i++) weight[i] = 1.0 / pow(i + 1, 1.2);
+       discrete_distribution<int> payer(weight.begin(), weight.end());
+       for (int i = 0; i < count; i++) ledger.push_back({payer(rng), anyone(rng), amount(rng)});
+   } else {                                             // clustered
+       vector<int> groupStart = {0};
+       while (groupStart.back() < people) groupStart.push_back(min(people, groupStart.back() + 4 + (int)(rng() % 3)));
+       int groups = groupStart.size() - 1;
+       for (int i = 0; i < count; i++) {
+           int g = rng() % groups;
+           int size = groupStart[g + 1] - groupStart[g];
+           ledger.push_back({groupStart[g] + (int)(rng() % size), groupStart[g] + (int)(rng() % size), amount(rng)});
+       }
+   }
+   return ledger;
+}
+
+struct Measurement {
+   double millis = 0;
+   long long allocations = 0;
+   long long allocatedBytes = 0;
+   long long transfers = 0;
+   long peakKb = 0;
+   bool proved = false;                                 // solver proved its plan minimal
+   bool finished = false;
+};
+
+struct SolverCase {
+   string name;
+   int maxPeople;                                       // skip larger N (known to be out of reach)
+   // returns transfers; sets `proved` when the plan is known to be minimal
+   function<long long(const vector<array<int, 3>>&, function<void()>, bool&)> run;
+};
+
+// Runs one solver in a forked child; setup happens before `start()` is called
+Measurement measure(const SolverCase& solver, const string& kind, int people, unsigned seed) {
+   int channel[2];
+   if (pipe(channel) != 0) throw runtime_error("pipe failed");
+   pid_t child = fork();
+   if (child < 0) throw runtime_error("fork failed");
+   if (child == 0) {
+       close(channel[0]);
+       alarm(TIME_LIMIT_SECONDS);
+       mt19937 rng(seed);
+       auto ledger = generateLedger(kind, people, rng);
+       Measurement m;
+       chrono::steady_clock::time_point begin;
+       long long allocationsBefore = 0, bytesBefore = 0;
+       auto start = [&]() {
+           allocationsBefore = allocationCount.load();
+           bytesBefore = allocationBytes.load();
+           begin = chrono::steady_clock::now();
+       };
+       m.transfers = solver.run(ledger, start, m.proved);
+       m.millis = chrono::duration<double, milli>(chrono::steady_clock::now() - begin).count();
+       m.allocations = allocationCount.load() - allocationsBefore;
+       m.allocatedBytes = allocationBytes.load() - bytesBefore;
+       m.finished = true;
+       if (write(channel[1], &m, sizeof(m)) != sizeof(m)) _exit(1);
+       _exit(0);
+   }
+   close(channel[1]);
+   Measurement m;
+   if (read(channel[0], &m, sizeof(m)) != sizeof(m)) m.finished = false;
+   close(channel[0]);
+   int status;
+   struct rusage usage;
+   wait4(child, &status, 0, &usage);
+   m.peakKb = usage.ru_maxrss;
+   return m;
+}
+
+vector<vector<int>> asRows(const vector<array<int, 3>>& ledger) {
+   vector<vector<int>> rows;
+   for (auto& t : ledger) rows.push_back({t[0], t[1], t[2]});
+   return rows;
+}
+
+vector<service::Transaction> asTransactions(const vector<array<int, 3>>& ledger) {
+   vector<service::Transaction> rows;
+   for (auto& t : ledger) rows.emplace_back("P" + to_string(t[0]), "P" + to_string(t[1]), t[2]);
+   return rows;
+}
+
+vector<SolverCase> solvers() {
+   int threads = max(1u, thread::hardware_concurrency());
+   return {
+       {"split1 greedy heaps", INT_MAX, [](auto& ledger, auto start, bool&) {
+           auto rows = asRows(ledger);
+           start();
+           return (long long)greedy::Solution().minTransfers(rows, thread::hardware_concurrency());
+       }},
+       {"split2 subset DP", exact::Solution::MAX_EXACT_PEOPLE, [](auto& ledger, auto start, bool& proved) {
+           auto rows = asRows(ledger);
+           start();
+           proved = true;
+           return (long long)exact::Solution().settleExact(rows).size();
+       }},
+       {"split2 branch and bound", 60, [threads](auto& ledger, auto start, bool& proved) {
+           auto rows = asRows(ledger);
+           start();
+           return (long long)exact::Solution().settleBranchAndBound(rows, threads, SEARCH_BUDGET, proved).size();
+       }},
+       {"split2 anytime", INT_MAX, [threads](auto& ledger, auto start, bool&) {
+           auto rows = asRows(ledger);
+           start();
+           return (long long)exact::Solution().settleAnytime(rows, SEARCH_BUDGET, threads).size();
+       }},
+       {"settleBasic", INT_MAX, [](auto& ledger, auto start, bool&) {
+           auto rows = asTransactions(ledger);
+           start();
+           return (long long)service::SettlementService().settleBasic(rows).size();
+       }},
+       {"settleOptimal", INT_MAX, [](auto& ledger, auto start, bool&) {
+           auto rows = asTransactions(ledger);
+           start();
+           return (long long)service::SettlementService().settleOptimal(rows).size();
+       }},
+       {"settleOptimalInterned", INT_MAX, [threads](auto& ledger, auto start, bool&) {
+           auto rows = asTransactions(ledger);
+           start();
+           return (long long)service::SettlementService().settleOptimalInterned(rows, threads).size();
+       }},
+   };
+}
+
+int main(int argc, char** argv) {
+   vector<int> sizes = {8, 12, 16, 20, 24, 32, 48, 1000, 100000};
+   if (argc > 1) {
+       sizes.clear();
+       for (int i = 1; i < argc; i++) sizes.push_back(atoi(argv[i]));
+   }
+   auto cases = solvers();
+   // per generator and N: fewest transfers seen, fastest solver reaching it, and whether any solver proved it
+   struct Pick { int people; long long transfers; string solver; double millis; bool proved; };
+   vector<pair<string, Pick>> picks;
+
+   for (string kind : {"uniform", "power-law", "clustered"}) {
+       cout << "===== " << kind << " ledgers =====\n";
+       cout << left << setw(10) << "  N" << setw(26) << "solver" << right << setw(12) << "ms"
+            << setw(12) << "allocs" << setw(12) << "alloc KB" << setw(12) << "peak KB" << setw(11) << "transfers"
+            << setw(8) << "proved" << "\n";
+       for (int people : sizes) {
+           Pick pick{people, LLONG_MAX, "", 0, false};
+           for (auto& solver : cases) {
+               if (people > solver.maxPeople) continue;
+               Measurement m = measure(solver, kind, people, 1000 + people);
+               cout << left << setw(10) << ("  " + to_string(people)) << setw(26) << solver.name << right;
+               if (!m.finished) {
+                   cout << setw(12) << ">" + to_string(TIME_LIMIT_SECONDS) + "s" << "   (killed)\n";
+                   continue;
+               }
+               cout << setw(12) << fixed << setprecision(2) << m.millis << setw(12) << m.allocations
+                    << setw(12) << m.allocatedBytes / 1024 << setw(12) << m.peakKb << setw(11) << m.transfers
+                    << setw(8) << (m.proved ? "yes" : "") << "\n";
+               if (m.transfers < pick.transfers || (m.transfers == pick.transfers && m.millis < pick.millis)) {
+                   bool proved = pick.proved && m.transfers == pick.transfers;
+                   pick = {people, m.transfers, solver.name, m.millis, proved};
+               }
+               if (m.proved && m.transfers == pick.transfers) pick.proved = true;
+           }
+           if (!pick.solver.empty()) picks.push_back({kind, pick});
+       }
+       cout << "\n";
+   }
+
+   // Solver choice per request size: the fastest plan with the fewest transfers;
+   // "proved" marks sizes where an exact solver confirmed that count is the minimum
+   cout << "===== fastest solver reaching the fewest transfers =====\n";
+   for (auto& [kind, pick] : picks) {
+       cout << "  " << left << setw(12) << kind << right << setw(8) << pick.people << "  " << left << setw(26)
+            << pick.solver << right << setw(12) << fixed << setprecision(2) << pick.millis << setw(11)
+            << pick.transfers << setw(8) << (pick.proved ? "proved" : "") << "\n";
+   }
+   return 0;
+}
@@ -0,0 +1,192 @@
+#pragma once
+#include <vector>
+#include <unordered_map>
+#include <climits>
+#include <algorithm>
+#include <functional>
+#include <thread>
+using namespace std;
+
+
+// Shared by Split1.cpp and Split2.cpp.
+
+// Beyond this many people the pair-sum table of the triple/quad pass gets too large
+const int MAX_MITM_PEOPLE = 2000;
+
+
+/*
+Time Complexity: O(N) for pairs, O(N^2) expected for triples/quads
+Zero-sum pre-pass. Pulls out, in this order:
+- exact-cancel pairs (b, -b)
+- triples whose sum is zero (pair-sum table lookup)
+- quads: two disjoint pairs with opposite pair sums
+  (meet in the middle over the same pair-sum table)
+Only pairs are always safe: some optimal plan settles
+every exact-cancel pair on its own. Triples and quads
+are taken greedily and can block a better grouping, so
+they are skipped when largestGroup is 2. Pair sums are
+only tabled while at most MAX_MITM_PEOPLE remain.
+Returns the groups (indices into balances); `remaining`
+receives everyone not placed in a group.
+*/
+inline vector<vector<int>> smallZeroSumGroups(const vector<int>& balances, vector<int>& remaining,
+                                              int largestGroup = 4) {
+   int n = balances.size();
+   vector<char> alive(n, 1);
+   vector<vector<int>> groups;
+   // Exact-cancel pairs
+   unordered_map<int, vector<int>> waiting;             // balance -> unmatched indices
+   for (int i = 0; i < n; i++) {
+       auto it = waiting.find(-balances[i]);
+       if (it != waiting.end() && !it->second.empty()) {
+           groups.push_back({it->second.back(), i});
+           alive[it->second.back()] = alive[i] = 0;
+           it->second.pop_back();
+       } else {
+           waiting[balances[i]].push_back(i);
+       }
+   }
+   vector<int> live;
+   for (int i = 0; i < n; i++) {
+       if (alive[i]) live.push_back(i);
+   }
+   if (largestGroup > 2 && (int)live.size() <= MAX_MITM_PEOPLE) {
+       unordered_map<long long, vector<pair<int, int>>> pairSums;
+       for (int a = 0; a < (int)live.size(); a++) {
+           for (int b = a + 1; b < (int)live.size(); b++) {
+               pairSums[(long long)balances[live[a]] + balances[live[b]]].push_back({live[a], live[b]});
+           }
+       }
+       auto findPair = [&](long long sum, int avoidA, int avoidB) -> pair<int, int> {
+           auto it = pairSums.find(sum);
+           if (it == pairSums.end()) return {-1, -1};
+           for (auto [i, j] : it->second) {
+               if (alive[i] && alive[j] && i != avoidA && i != avoidB && j != avoidA && j != avoidB) return {i, j};
+           }
+           return {-1, -1};
+       };
+       // Triples: k plus a pair summing to -balances[k]
+       for (int k : live) {
+           if (!alive[k]) continue;
+           auto [i, j] = findPair(-(long long)balances[k], k, k);
+           if (i < 0) continue;
+           groups.push_back({i, j, k});
+           alive[i] = alive[j] = alive[k] = 0;
+       }
+       // Quads: two disjoint pairs with opposite sums
+       for (int a = 0; a < (int)live.size() && largestGroup > 3; a++) {
+           for (int b = a + 1; b < (int)live.size() && alive[live[a]]; b++) {
+               int i = live[a], j = live[b];
+               if (!alive[j]) continue;
+               auto [k, l] = findPair(-((long long)balances[i] + balances[j]), i, j);
+               if (k < 0) continue;
+               groups.push_back({i, j, k, l});
+               alive[i] = alive[j] = alive[k] = alive[l] = 0;
+           }
+       }
+   }
+   remaining.clear();
+   for (int i = 0; i < n; i++) {
+       if (alive[i]) remaining.push_back(i);
+   }
+   return groups;
+}
+
+
+/*
+-------------------------------------------------------
+SHARDED NET BALANCE
+-------------------------------------------------------
+Each worker owns a contiguous shard of the transactions
+and accumulates into its own array, so there is no
+sharing while scanning. Person ids that fit a dense
+range (total shard arrays no bigger than a few times
+the input) use dense arrays; otherwise each shard keeps
+a sorted {person, delta} list.
+Merge: every id is summed over shards in shard order.
+Sums are integers, so the result is bit-identical to
+the serial loop (threads = 1 takes the same path).
+Returns {person, balance} for non-zero balances,
+sorted by person.
+Time Complexity: O(T / threads + range) dense,
+                 O(T log T / threads + P log P) sparse
+*/
+inline vector<pair<int, int>> shardedNetBalances(const vector<vector<int>>& transactions, int threads) {
+   const int MIN_SHARD = 1 << 14;                       // smaller shards are not worth a thread
+   long long count = transactions.size();
+   int shards = (int)max(1LL, min<long long>(max(1, threads), count / MIN_SHARD));
+   auto runShards = [&](const function<void(int, long long, long long)>& body) {
+       vector<thread> workers;
+       for (int s = 1; s < shards; s++) workers.emplace_back(body, s, count * s / shards, count * (s + 1) / shards);
+       body(0, 0, count / shards);
+       for (auto& w : workers) w.join();
+   };
+
+   // Pass 1: id range per shard
+   vector<int> shardLo(shards, INT_MAX), shardHi(shards, INT_MIN);
+   runShards([&](int s, long long begin, long long end) {
+       for (long long i = begin; i < end; i++) {
+           auto& txn = transactions[i];
+           shardLo[s] = min({shardLo[s], txn[0], txn[1]});
+           shardHi[s] = max({shardHi[s], txn[0], txn[1]});
+       }
+   });
+   int lo = *min_element(shardLo.begin(), shardLo.end());
+   int hi = *max_element(shardHi.begin(), shardHi.end());
+   vector<pair<int, int>> people;
+   if (count == 0) return people;
+   long long range = (long long)hi - lo + 1;
+
+   if (range * shards <= 4 * count + 4096) {
+       // Pass 2 (dense): thread-local arrays indexed by id - lo
+       vector<vector<long long>> local(shards);
+       runShards([&](int s, long long begin, long long end) {
+           local[s].assign(range, 0);
+           for (long long i = begin; i < end; i++) {
+               auto& txn = transactions[i];
+               local[s][txn[0] - lo] -= txn[2];
+               local[s][txn[1] - lo] += txn[2];
+           }
+       });
+       // Merge: stripes of ids in parallel, shards summed in order into shard 0
+       runShards([&](int s, long long, long long) {
+           for (long long id = range * s / shards; id < range * (s + 1) / shards; id++) {
+               long long sum = 0;
+               for (int k = 0; k < shards; k++) sum += local[k][id];
+               local[0][id] = sum;
+           }
+       });
+       for (long long id = 0; id < range; id++) {
+           if ((int)local[0][id] != 0) people.push_back({(int)(id + lo), (int)local[0][id]});
+       }
+       return people;
+   }
+
+   // Pass 2 (sparse): sorted, combined {person, delta} per shard
+   vector<vector<pair<int, long long>>> local(shards);
+   runShards([&](int s, long long begin, long long end) {
+       auto& deltas = local[s];
+       for (long long i = begin; i < end; i++) {
+           auto& txn = transactions[i];
+           deltas.push_back({txn[0], -(long long)txn[2]});
+           deltas.push_back({txn[1], txn[2]});
+       }
+       sort(deltas.begin(), deltas.end(), [](auto& a, auto& b) { return a.first < b.first; });
+       int out = 0;
+       for (int i = 0; i < (int)deltas.size(); i++) {
+           if (out > 0 && deltas[out - 1].first == deltas[i].first) deltas[out - 1].second += deltas[i].second;
+           else deltas[out++] = deltas[i];
+       }
+       deltas.resize(out);
+   });
+   vector<pair<int, long long>> merged;
+   for (auto& deltas : local) merged.insert(merged.end(), deltas.begin(), deltas.end());
+   stable_sort(merged.begin(), merged.end(), [](auto& a, auto& b) { return a.first < b.first; });
+   for (int i = 0; i < (int)merged.size();) {
+       long long sum = 0;
+       int person = merged[i].first;
+       for (; i < (int)merged.size() && merged[i].first == person; i++) sum += merged[i].second;
+       if ((int)sum != 0) people.push_back({person, (int)sum});
+   }
+   return people;
+}
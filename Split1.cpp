@@ -1,6 +1,8 @@
 #include <vector>
 #include <unordered_map>
 #include <queue>
+#include <algorithm>
+#include "Split.h"
 using namespace std;
 
 
@@ -9,7 +11,7 @@ public:
 
 
    /*
-   Time Complexity: O(T + N log N)
+   Time Complexity: O(T / threads + N log N)
    T = number of transactions
    N = number of people with non-zero balance
 
@@ -17,22 +19,23 @@ public:
    Note:
    - This is a greedy approach
    - Does NOT guarantee minimum number of transactions
+   - Exact-cancel pairs are settled first (one transfer each),
+     the heaps only see the residual balances
    */
-   int minTransfers(vector<vector<int>>& transactions) {
+   int minTransfers(vector<vector<int>>& transactions, int threads = 1) {
 
 
-       unordered_map<int, int> netBalance;
+       // Step 1: Compute net balances (sharded over threads, same result as a serial loop)
+       vector<pair<int, int>> netBalance = shardedNetBalances(transactions, threads);
 
 
-       // Step 1: Compute net balances
-       for (auto& txn : transactions) {
-           int from = txn[0];
-           int to = txn[1];
-           int amount = txn[2];
-
-
-           netBalance[from] -= amount;
-           netBalance[to] += amount;
+       // Step 2: Exact-cancel pairs (O(N); the triple/quad search would cost O(N^2))
+       vector<int> balances;
+       for (auto& entry : netBalance) balances.push_back(entry.second);
+       vector<int> remaining;
+       int transactionsCount = 0;
+       for (auto& group : smallZeroSumGroups(balances, remaining, 2)) {
+           transactionsCount += group.size() - 1;
        }
 
 
@@ -44,9 +47,9 @@ public:
        priority_queue<int> debtors;
 
 
-       // Step 2: Separate balances
-       for (auto& entry : netBalance) {
-           int balance = entry.second;
+       // Step 3: Separate residual balances
+       for (int idx : remaining) {
+           int balance = balances[idx];
 
 
            if (balance > 0) {
@@ -58,10 +61,7 @@ public:
        }
 
 
-       int transactionsCount = 0;
-
-
-       // Step 3: Greedy settlement
+       // Step 4: Greedy settlement
        while (!creditors.empty() && !debtors.empty()) {
 
 
@@ -1,71 +1,575 @@
 #include <vector>
 #include <unordered_map>
-#include <climits>
+#include <algorithm>
+#include <queue>
+#include <deque>
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <stdexcept>
+#include "Split.h"
 using namespace std;
+
+
+/*
+-------------------------------------------------------
+PARALLEL BRANCH AND BOUND (minimum transfers)
+-------------------------------------------------------
+Same branching as the classic backtracking: the first
+unsettled person settles fully against one opposite-sign
+partner. On top of that:
+ - lower bound: transfers so far + max(#debtors, #creditors)
+   left, since every remaining person needs a transfer
+ - upper bound: shared best-so-far, seeded by the caller
+ - partners with equal balances are tried once; an exact
+   cancel is taken alone (it is never worse)
+ - per-worker memo of remaining balance multisets with
+   the fewest transfers seen; the full sorted multiset is
+   the key, so a hash collision never prunes a live branch
+   (provedOptimal stays honest). Being per worker, it needs
+   no lock; keys live in one flat array, so nodes do not
+   allocate and freeing it is a handful of frees. It starts
+   small and doubles while half full, up to a cap sized from
+   N and the budget (what a worker can insert in that time)
+ - workers are capped by N: a small instance does not have
+   enough subtrees to keep many busy
+ - the top SPLIT_DEPTH levels become tasks on per-worker
+   deques; owners pop from the back, idle workers steal
+   from the front of others' deques
+ - a wall-clock deadline stops everyone; the best plan
+   found so far is returned
+*/
+class ParallelSettlementSearch {
+private:
+   static const int SPLIT_DEPTH = 3;                    // levels expanded into stealable tasks
+   static const size_t MIN_MEMO_SLOTS = 1 << 10;        // first allocation per worker
+   static const size_t MAX_MEMO_SLOTS = 1 << 18;        // per worker; filled at most half way
+   static const long long MEMO_INSERTS_PER_MS = 2000;   // per worker, roughly (new multisets per ms)
+   static const int PEOPLE_PER_WORKER = 6;              // fewer people leave too few subtrees to share
+
+   struct Task {
+       vector<int> balances;
+       int index;
+       vector<array<int, 3>> path;                      // {payer idx, receiver idx, amount}
+   };
+   struct WorkerQueue {
+       mutex lock;
+       deque<Task> tasks;
+   };
+   struct MemoEntry {
+       unsigned long long hash;
+       int offset, length;                              // sorted multiset in keys[offset, offset + length)
+       int fewest;                                      // fewest transfers seen; length -1 = empty slot
+   };
+   struct WorkerLocal {                                 // touched only by its owner: no locks
+       vector<MemoEntry> slots;                         // open addressing, power of two <= memoCap
+       vector<int> keys;                                // memo keys, back to back
+       size_t used = 0;
+       vector<int> rest;                                // scratch: sorted remaining balances
+       vector<vector<int>> partners;                    // scratch: candidate list per depth
+   };
+
+   int n;
+   size_t memoCap;                                      // slot limit per worker for this solve
+   chrono::steady_clock::time_point deadline;
+   atomic<int> bestCount;
+   mutex bestLock;
+   vector<array<int, 3>> bestPath;
+   atomic<bool> timedOut{false};
+   atomic<int> pending{0};                              // tasks queued or running
+   vector<WorkerQueue> queues;
+   vector<WorkerLocal> locals;
+
+   static unsigned long long mix(unsigned long long h, unsigned long long x) {
+       h ^= x + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+       return h * 0xff51afd7ed558ccdULL;
+   }
+
+   // doubles a worker's memo table; keys stay where they are, only slots move
+   static void grow(WorkerLocal& local) {
+       vector<MemoEntry> old(local.slots.size() * 2, MemoEntry{0, 0, -1, 0});
+       old.swap(local.slots);
+       size_t mask = local.slots.size() - 1;
+       for (auto& entry : old) {
+           if (entry.length < 0) continue;
+           size_t i = entry.hash & mask;
+           while (local.slots[i].length >= 0) i = (i + 1) & mask;
+           local.slots[i] = entry;
+       }
+   }
+
+   // true if this worker already reached this multiset with no more transfers
+   bool seenBefore(int worker, const vector<int>& balances, int index, int used) {
+       WorkerLocal& local = locals[worker];
+       if (2 * local.used >= local.slots.size() && local.slots.size() < memoCap) grow(local);
+       vector<int>& rest = local.rest;
+       rest.clear();
+       for (int i = index; i < n; i++) {
+           if (balances[i] != 0) rest.push_back(balances[i]);
+       }
+       sort(rest.begin(), rest.end());
+       unsigned long long h = rest.size();
+       for (int b : rest) h = mix(h, (unsigned long long)(long long)b);
+       size_t mask = local.slots.size() - 1;
+       for (size_t i = h & mask; ; i = (i + 1) & mask) {
+           MemoEntry& entry = local.slots[i];
+           if (entry.length < 0) {                      // new multiset: remember it while there is room
+               if (2 * local.used < local.slots.size()) {
+                   entry = {h, (int)local.keys.size(), (int)rest.size(), used};
+                   local.keys.insert(local.keys.end(), rest.begin(), rest.end());
+                   local.used++;
+               }
+               return false;
+           }
+           if (entry.hash == h && entry.length == (int)rest.size()
+               && equal(rest.begin(), rest.end(), local.keys.begin() + entry.offset)) {
+               if (entry.fewest <= used) return true;
+               entry.fewest = used;
+               return false;
+           }
+       }
+   }
+
+   int lowerBound(const vector<int>& balances, int index) const {
+       int debtors = 0, creditors = 0;
+       for (int i = index; i < n; i++) {
+           if (balances[i] > 0) creditors++;
+           else if (balances[i] < 0) debtors++;
+       }
+       return max(debtors, creditors);
+   }
+
+   void offer(const vector<array<int, 3>>& path) {
+       lock_guard<mutex> guard(bestLock);
+       if ((int)path.size() < bestCount.load()) {
+           bestPath = path;
+           bestCount.store(path.size());
+       }
+   }
+
+   // Candidate partners for `index`, in the order they should be tried (into the worker's list for this depth)
+   const vector<int>& partners(int worker, const vector<int>& balances, int index, int depth) {
+       vector<int>& result = locals[worker].partners[depth];
+       result.clear();
+       for (int next = index + 1; next < n; next++) {
+           if (balances[index] + balances[next] == 0) { result.push_back(next); return result; }   // exact cancel dominates
+       }
+       for (int next = index + 1; next < n; next++) {
+           if ((long long)balances[index] * balances[next] >= 0) continue;
+           bool duplicate = false;
+           for (int seen : result) duplicate = duplicate || balances[seen] == balances[next];
+           if (!duplicate) result.push_back(next);
+       }
+       return result;
+   }
+
+   // Returns false if the node was cut (settled, pruned, or out of time)
+   bool enter(int worker, vector<int>& balances, int& index, const vector<array<int, 3>>& path) {
+       while (index < n && balances[index] == 0) index++;
+       if (index == n) { offer(path); return false; }
+       if ((int)path.size() + lowerBound(balances, index) >= bestCount.load()) return false;
+       if (timedOut.load()) return false;
+       if (chrono::steady_clock::now() > deadline) { timedOut.store(true); return false; }
+       return !seenBefore(worker, balances, index, path.size());
+   }
+
+   void settle(vector<int>& balances, int index, int next, vector<array<int, 3>>& path) {
+       int amount = balances[index];
+       if (amount > 0) path.push_back({next, index, amount});     // partner pays index
+       else path.push_back({index, next, -amount});
+       balances[next] += amount;
+   }
+
+   void dfs(int worker, vector<int>& balances, int index, vector<array<int, 3>>& path) {
+       if (!enter(worker, balances, index, path)) return;
+       for (int next : partners(worker, balances, index, path.size())) {
+           int before = balances[next];
+           settle(balances, index, next, path);
+           dfs(worker, balances, index + 1, path);
+           path.pop_back();
+           balances[next] = before;
+       }
+   }
+
+   void push(int worker, Task&& task) {
+       pending++;
+       lock_guard<mutex> guard(queues[worker].lock);
+       queues[worker].tasks.push_back(move(task));
+   }
+
+   bool take(int worker, Task& task) {
+       {
+           lock_guard<mutex> guard(queues[worker].lock);
+           if (!queues[worker].tasks.empty()) {
+               task = move(queues[worker].tasks.back());
+               queues[worker].tasks.pop_back();
+               return true;
+           }
+       }
+       for (int k = 1; k < (int)queues.size(); k++) {  // steal the oldest (largest) subtree
+           WorkerQueue& victim = queues[(worker + k) % queues.size()];
+           lock_guard<mutex> guard(victim.lock);
+           if (!victim.tasks.empty()) {
+               task = move(victim.tasks.front());
+               victim.tasks.pop_front();
+               return true;
+           }
+       }
+       return false;
+   }
+
+   void work(int worker) {
+       Task task;
+       while (pending.load() > 0) {
+           if (!take(worker, task)) { this_thread::yield(); continue; }
+           if ((int)task.path.size() < SPLIT_DEPTH) {
+               int index = task.index;
+               if (enter(worker, task.balances, index, task.path)) {
+                   for (int next : partners(worker, task.balances, index, task.path.size())) {
+                       Task child{task.balances, index + 1, task.path};
+                       settle(child.balances, index, next, child.path);
+                       push(worker, move(child));
+                   }
+               }
+           } else {
+               dfs(worker, task.balances, task.index, task.path);
+           }
+           pending--;
+       }
+   }
+
+public:
+   /*
+   balances: non-zero net balances (positive = should receive)
+   seed: any valid plan, used as the initial upper bound
+   Returns the best plan as {payer idx, receiver idx, amount};
+   provedOptimal is false if the deadline cut the search short.
+   */
+   vector<array<int, 3>> solve(const vector<int>& balances, const vector<array<int, 3>>& seed,
+                               int threads, chrono::milliseconds budget, bool& provedOptimal) {
+       n = balances.size();
+       deadline = budget == chrono::milliseconds::max() ? chrono::steady_clock::time_point::max()
+                                                        : chrono::steady_clock::now() + budget;
+       bestPath = seed;
+       bestCount.store(seed.size());
+       // memo cap: twice the inserts the budget allows, and no more than 2^n multisets exist
+       double inserts = (double)(1LL << min(n, 40));
+       if (budget != chrono::milliseconds::max()) inserts = min(inserts, (double)MEMO_INSERTS_PER_MS * budget.count());
+       for (memoCap = MIN_MEMO_SLOTS; memoCap < MAX_MEMO_SLOTS && memoCap < 2 * inserts; memoCap *= 2) {}
+       queues = vector<WorkerQueue>(max(1, min(threads, n / PEOPLE_PER_WORKER)));
+       locals = vector<WorkerLocal>(queues.size());
+       for (auto& local : locals) {
+           local.slots.assign(MIN_MEMO_SLOTS, MemoEntry{0, 0, -1, 0});
+           local.partners.resize(n + 1);
+       }
+       push(0, Task{balances, 0, {}});
+       vector<thread> workers;
+       for (int w = 1; w < (int)queues.size(); w++) workers.emplace_back(&ParallelSettlementSearch::work, this, w);
+       work(0);
+       for (auto& t : workers) t.join();
+       provedOptimal = !timedOut.load();
+       return bestPath;
+   }
+};
+
+
 class Solution {
+public:
+   // Beyond this many non-zero balances the 2^N tables stop fitting in memory / milliseconds
+   static const int MAX_EXACT_PEOPLE = 22;
+
 private:
+   // Net balance per person, positive = should receive; sorted by person id, zeros dropped
+   vector<pair<int, int>> nonZeroBalances(vector<vector<int>>& transactions, int threads = 1) {
+       return shardedNetBalances(transactions, threads);
+   }
+
    /*
-   Time Complexity: O(N!)
+   Time Complexity: O(2^N * N)
+   Space Complexity: O(2^N)
    N = number of people with non-zero balance
    Explanation:
-   - At each step, we try settling current debt with all possible opposite balances
-   - In worst case → factorial branching
+   - A zero-sum group of k people settles with k - 1 transfers,
+     so minimum transfers = N - (max number of disjoint zero-sum groups)
+   - subsetSum[mask] is built from mask without its lowest bit
+   - groups[mask] = max over i in mask of groups[mask ^ i],
+     plus one if subsetSum[mask] == 0
+   - Walking the argmax back from the full mask yields an order
+     of people whose zero-sum prefixes delimit the groups
+   Returns the groups as lists of indices into balances.
    */
-   int settleDebts(int currentIndex, vector<int>& balances) {
-       // Skip settled (zero) balances
-       while (currentIndex < balances.size() && balances[currentIndex] == 0) {
-           currentIndex++;
-       }
-       // All debts settled
-       if (currentIndex == balances.size()) return 0;
-       int minTransactions = INT_MAX;
-       // Try settling current person with others
-       for (int next = currentIndex + 1; next < balances.size(); next++) {
-           // Only settle with opposite sign (creditor vs debtor)
-           if (balances[currentIndex] * balances[next] < 0) {
-               // Settle currentIndex with next
-               balances[next] += balances[currentIndex];
-               // Recurse for remaining
-               int transactions = 1 + settleDebts(currentIndex + 1, balances);
-               minTransactions = min(minTransactions, transactions);
-               // Backtrack
-               balances[next] -= balances[currentIndex];
-               // Optimization:
-               // If perfect settlement (becomes zero), no need to try further
-               if (balances[next] + balances[currentIndex] == 0) break;
+   vector<vector<int>> zeroSumGroups(const vector<int>& balances) {
+       int n = balances.size();
+       int full = (1 << n) - 1;
+       vector<int> subsetSum(1 << n, 0);
+       vector<unsigned char> groups(1 << n, 0);
+       for (int mask = 1; mask <= full; mask++) {
+           int low = __builtin_ctz(mask);
+           subsetSum[mask] = subsetSum[mask & (mask - 1)] + balances[low];
+           int best = 0;
+           for (int rest = mask; rest; rest &= rest - 1) {
+               best = max(best, (int)groups[mask ^ (rest & -rest)]);
            }
+           groups[mask] = best + (subsetSum[mask] == 0);
+       }
+       // Reconstruct: peel one person at a time while staying on an optimal path
+       vector<vector<int>> result;
+       vector<int> current;
+       for (int mask = full; mask; ) {
+           int bonus = subsetSum[mask] == 0;
+           if (bonus && !current.empty()) {            // prefix `mask` closes the group peeled since
+               result.push_back(current);
+               current.clear();
+           }
+           for (int rest = mask; rest; rest &= rest - 1) {
+               int bit = rest & -rest;
+               if (groups[mask ^ bit] + bonus == groups[mask]) {
+                   current.push_back(__builtin_ctz(bit));
+                   mask ^= bit;
+                   break;
+               }
+           }
+       }
+       if (!current.empty()) result.push_back(current);
+       return result;
+   }
+
+
+   // Settle one zero-sum group as a chain (k - 1 transfers), appending {payer, receiver, amount}
+   void appendChain(const vector<pair<int, int>>& people, const vector<int>& group,
+                    vector<vector<int>>& transfers) {
+       int carry = 0;                                   // imbalance passed along the chain
+       for (int k = 0; k + 1 < (int)group.size(); k++) {
+           int curr = people[group[k]].first, next = people[group[k + 1]].first;
+           int owed = people[group[k]].second + carry;  // > 0: curr still has to receive
+           if (owed > 0) transfers.push_back({next, curr, owed});
+           else if (owed < 0) transfers.push_back({curr, next, -owed});
+           carry = owed;
+       }
+   }
+
+   /*
+   Time Complexity: O(N log N)
+   Heap greedy (largest debtor pays largest creditor), as in
+   Split1. Not minimal, but a valid plan to seed the bound.
+   */
+   vector<array<int, 3>> greedyPlan(const vector<int>& balances) {
+       priority_queue<pair<int, int>> creditors, debtors;  // {amount, idx}
+       for (int i = 0; i < (int)balances.size(); i++) {
+           if (balances[i] > 0) creditors.push({balances[i], i});
+           else if (balances[i] < 0) debtors.push({-balances[i], i});
+       }
+       vector<array<int, 3>> plan;
+       while (!creditors.empty() && !debtors.empty()) {
+           auto [credit, creditor] = creditors.top(); creditors.pop();
+           auto [debt, debtor] = debtors.top(); debtors.pop();
+           int settledAmount = min(credit, debt);
+           plan.push_back({debtor, creditor, settledAmount});
+           if (credit > settledAmount) creditors.push({credit - settledAmount, creditor});
+           if (debt > settledAmount) debtors.push({debt - settledAmount, debtor});
        }
-       return minTransactions;
+       return plan;
+   }
+
+   /*
+   Time Complexity: O(N^2) expected
+   Zero-sum pairs, triples and quads settled as chains, heap
+   greedy on the rest. Usually beats greedyPlan, but only as
+   a seed: the greedy grouping is not always optimal.
+   */
+   vector<array<int, 3>> groupedGreedyPlan(const vector<int>& balances) {
+       vector<pair<int, int>> indexed;                  // {idx, balance}: chains come out in indices
+       for (int i = 0; i < (int)balances.size(); i++) indexed.push_back({i, balances[i]});
+       vector<int> remaining, rest;
+       vector<vector<int>> chains;
+       for (auto& group : smallZeroSumGroups(balances, remaining)) appendChain(indexed, group, chains);
+       vector<array<int, 3>> plan;
+       for (auto& t : chains) plan.push_back({t[0], t[1], t[2]});
+       for (int i : remaining) rest.push_back(balances[i]);
+       for (auto& t : greedyPlan(rest)) plan.push_back({remaining[t[0]], remaining[t[1]], t[2]});
+       return plan;
+   }
+
+   // subset DP plan from aggregated balances ({person, balance}, non-zero)
+   vector<vector<int>> exactPlan(const vector<pair<int, int>>& people) {
+       if ((int)people.size() > MAX_EXACT_PEOPLE)
+           throw invalid_argument("settleExact: more than MAX_EXACT_PEOPLE non-zero balances");
+       vector<int> balances;
+       for (auto& p : people) balances.push_back(p.second);
+       vector<vector<int>> transfers;
+       for (auto& group : zeroSumGroups(balances)) appendChain(people, group, transfers);
+       return transfers;
+   }
+
+   // branch and bound plan from aggregated balances ({person, balance}, non-zero)
+   vector<vector<int>> branchAndBoundPlan(const vector<pair<int, int>>& people, int threads,
+                                          chrono::milliseconds budget, bool& provedOptimal) {
+       vector<int> balances;
+       for (auto& p : people) balances.push_back(p.second);
+       ParallelSettlementSearch search;
+       auto plan = search.solve(balances, greedyPlan(balances), threads, budget, provedOptimal);
+       vector<vector<int>> transfers;
+       for (auto& t : plan) transfers.push_back({people[t[0]].first, people[t[1]].first, t[2]});
+       return transfers;
+   }
+
+   // true if the subset DP over n people fits in `left` (~1 ns per step)
+   static bool dpFits(int n, chrono::milliseconds left) {
+       return n <= MAX_EXACT_PEOPLE && (double)(1LL << n) * n * 1e-6 <= (double)left.count();
+   }
+
+   /*
+   Time Complexity: O(T + N) expected
+   Independent zero-sum clusters of the residual (indices into
+   people, from `remaining`): people linked by a transaction,
+   directly or through people whose balance nets to zero, share
+   a cluster, and so do both sides of each exact-cancel pair
+   (so every cluster's residual still sums to zero). Plans are
+   optimal per cluster; a zero-sum group of 3+ people spanning
+   two clusters is not searched for.
+   */
+   vector<vector<int>> zeroSumClusters(const vector<vector<int>>& transactions, const vector<pair<int, int>>& people,
+                                       const vector<vector<int>>& pairs, const vector<int>& remaining) {
+       unordered_map<int, int> node;                    // person id -> union-find node
+       vector<int> parent;
+       auto nodeOf = [&](int person) {
+           auto [it, fresh] = node.emplace(person, (int)parent.size());
+           if (fresh) parent.push_back(it->second);
+           return it->second;
+       };
+       auto find = [&](int x) {
+           while (parent[x] != x) x = parent[x] = parent[parent[x]];   // path halving
+           return x;
+       };
+       auto unite = [&](int a, int b) { parent[find(nodeOf(a))] = find(nodeOf(b)); };
+       for (auto& txn : transactions) unite(txn[0], txn[1]);
+       for (auto& group : pairs) unite(people[group[0]].first, people[group[1]].first);
+       unordered_map<int, int> clusterOf;               // root -> cluster index
+       vector<vector<int>> clusters;
+       for (int i : remaining) {
+           auto [it, fresh] = clusterOf.emplace(find(nodeOf(people[i].first)), (int)clusters.size());
+           if (fresh) clusters.emplace_back();
+           clusters[it->second].push_back(i);
+       }
+       return clusters;
    }
 public:
    /*
-   Time Complexity: O(T + N!)
+   Time Complexity: O(T + 2^N * N), N <= MAX_EXACT_PEOPLE
+   Returns the minimum set of transfers as {payer, receiver, amount}.
+   Each zero-sum group is settled as a chain: the running
+   imbalance is handed to the next member, k - 1 transfers.
+   Throws invalid_argument beyond MAX_EXACT_PEOPLE (use
+   settleBranchAndBound or settleAnytime there).
+   */
+   vector<vector<int>> settleExact(vector<vector<int>>& transactions) {
+       return exactPlan(nonZeroBalances(transactions));
+   }
+
+   /*
+   Time Complexity: exponential worst case, bounded by `budget`
+   For groups too large for the subset DP (N of 25-40).
+   Runs ParallelSettlementSearch seeded with the greedy plan.
+   Returns {payer, receiver, amount}; provedOptimal tells
+   whether the search finished inside the budget.
+   */
+   vector<vector<int>> settleBranchAndBound(vector<vector<int>>& transactions, int threads,
+                                            chrono::milliseconds budget, bool& provedOptimal) {
+       return branchAndBoundPlan(nonZeroBalances(transactions, threads), threads, budget, provedOptimal);
+   }
+
+   /*
+   Anytime hybrid settlement: best plan reachable within `budget`
+   (chrono::milliseconds::max() = no limit).
+   1. Exact-cancel pairs are settled directly: some optimal
+      plan always settles them on their own, so removing
+      them never costs a transfer
+   2. Residual:
+      - subset DP over all of it if N <= MAX_EXACT_PEOPLE and
+        its 2^N * N steps fit the remaining budget (optimal)
+      - otherwise split into independent zero-sum clusters
+        (see zeroSumClusters), smallest first. Each runs the
+        subset DP when it fits what is left of the budget,
+        else branch and bound on an equal share of it, seeded
+        with the better of the heap greedy and the triple/quad
+        pre-pass plan (so at worst that seed)
+   Returns {payer, receiver, amount}.
+   */
+   vector<vector<int>> settleAnytime(vector<vector<int>>& transactions, chrono::milliseconds budget,
+                                     int threads = 1) {
+       auto start = chrono::steady_clock::now();
+       auto left = [&]() {                              // remaining budget; max() stays unlimited
+           if (budget == chrono::milliseconds::max()) return budget;
+           auto spent = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start);
+           return max(budget - spent, chrono::milliseconds(0));
+       };
+       vector<pair<int, int>> people = nonZeroBalances(transactions, threads);
+       vector<int> balances;
+       for (auto& p : people) balances.push_back(p.second);
+       vector<int> remaining;
+       vector<vector<int>> transfers;
+       auto pairs = smallZeroSumGroups(balances, remaining, 2);
+       for (auto& group : pairs) appendChain(people, group, transfers);
+       if (remaining.empty()) return transfers;
+       if (dpFits(remaining.size(), left())) {
+           vector<pair<int, int>> residualPeople;
+           for (int i : remaining) residualPeople.push_back(people[i]);
+           auto plan = exactPlan(residualPeople);
+           transfers.insert(transfers.end(), plan.begin(), plan.end());
+           return transfers;
+       }
+
+       auto clusters = zeroSumClusters(transactions, people, pairs, remaining);
+       sort(clusters.begin(), clusters.end(), [](auto& a, auto& b) { return a.size() < b.size(); });
+       for (size_t c = 0; c < clusters.size(); c++) {
+           vector<pair<int, int>> clusterPeople;
+           vector<int> cluster;
+           for (int i : clusters[c]) {
+               clusterPeople.push_back(people[i]);
+               cluster.push_back(balances[i]);
+           }
+           vector<vector<int>> plan;
+           auto share = left();
+           if (dpFits(cluster.size(), share)) {
+               plan = exactPlan(clusterPeople);
+           } else {
+               if (share != chrono::milliseconds::max()) share /= (long long)(clusters.size() - c);   // larger ones follow
+               auto seed = greedyPlan(cluster);
+               auto grouped = groupedGreedyPlan(cluster);
+               if (grouped.size() < seed.size()) seed = grouped;
+               bool provedOptimal = false;
+               if (share.count() > 0) {
+                   ParallelSettlementSearch search;
+                   seed = search.solve(cluster, seed, threads, share, provedOptimal);
+               }
+               for (auto& t : seed) plan.push_back({clusterPeople[t[0]].first, clusterPeople[t[1]].first, t[2]});
+           }
+           transfers.insert(transfers.end(), plan.begin(), plan.end());
+       }
+       return transfers;
+   }
+
+   /*
+   Time Complexity: O(T + 2^N * N) for N <= MAX_EXACT_PEOPLE,
+   otherwise exponential (branch and bound)
    T = number of transactions
    N = number of unique people with non-zero balance
    Steps:
-   1. Compute net balance → O(T)
+   1. Compute net balance (sharded over threads) → O(T / threads)
    2. Filter non-zero balances → O(N)
-   3. DFS/backtracking → O(N!)
+   3. Subset DP for N <= MAX_EXACT_PEOPLE,
+      else parallel branch and bound without a time limit,
+      both on the balances from step 1 (aggregated once)
    */
    int minTransfers(vector<vector<int>>& transactions) {
-       unordered_map<int, int> netBalance;
-       // Step 1: Compute net balances
-       for (auto& txn : transactions) {
-           int from = txn[0];
-           int to = txn[1];
-           int amount = txn[2];
-           netBalance[from] -= amount;
-           netBalance[to] += amount;
-       }
-       // Step 2: Keep only non-zero balances
-       vector<int> balances;
-       for (auto& entry : netBalance) {
-           if (entry.second != 0) {
-               balances.push_back(entry.second);
-           }
-       }
-       // Step 3: Backtracking to minimize transactions
-       return settleDebts(0, balances);
+       int threads = max(1u, thread::hardware_concurrency());
+       // Steps 1-2: non-zero net balances
+       vector<pair<int, int>> people = nonZeroBalances(transactions, threads);
+       // Step 3: Subset DP when it fits, branch and bound otherwise
+       if ((int)people.size() <= MAX_EXACT_PEOPLE) return exactPlan(people).size();
+       bool provedOptimal;
+       return branchAndBoundPlan(people, threads, chrono::milliseconds::max(), provedOptimal).size();
    }
 };
-
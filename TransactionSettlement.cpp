@@ -2,9 +2,22 @@
 #include <vector>       // for vector
 #include <string>       // for string
 #include <unordered_map>// for unordered_map
+#include <string_view>  // for string_view
 #include <queue>        // for priority_queue
 #include <tuple>        // for tuple, get<>
-#include <algorithm>    // for min()
+#include <set>          // for set
+#include <iterator>     // for back_inserter
+#include <algorithm>    // for min(), make_heap, sort
+#include <climits>      // for LLONG_MIN
+#include <cstdint>      // for uint32_t
+#include <thread>       // for thread
+#include <functional>   // for function
+#include <stdexcept>    // for runtime_error
+#include <cstring>      // for memcpy
+#include <fcntl.h>      // for open
+#include <sys/mman.h>   // for mmap, madvise
+#include <sys/stat.h>   // for fstat
+#include <unistd.h>     // for close
 using namespace std; // use std namespace
 //===================================================== PART 1 : TRANSACTION MODEL ===============================================
 // class representing a single transaction <from, to, amount>
@@ -19,6 +32,205 @@ public:
         amount = a; // assign amount
     }
 };
+//===================================================== PART 3 : NAME INTERNING =================================================
+// maps person names to dense ids once, so settlement works on flat arrays
+class NameInterner {
+private:
+    unordered_map<string, uint32_t> ids; // name -> dense id
+    vector<string> names; // dense id -> name
+public:
+    // Time: O(1) average
+    uint32_t intern(const string& name) {
+        auto it = ids.find(name); // already known?
+        if (it != ids.end()) return it->second; // reuse id
+        uint32_t id = names.size(); // next dense id
+        ids.emplace(name, id); // remember mapping
+        names.push_back(name); // reverse mapping
+        return id;
+    }
+    // same, for a name that is not a string yet (e.g. a slice of a mapped file)
+    // the scratch key is reused, so known names cost no allocation
+    uint32_t intern(const char* data, size_t length) {
+        key.assign(data, length); // reuse scratch buffer
+        auto it = ids.find(key); // already known?
+        if (it != ids.end()) return it->second; // reuse id
+        return intern(key); // new person
+    }
+    // lookup only: false (and no new id) for a name never interned
+    bool find(const string& name, uint32_t& id) const {
+        auto it = ids.find(name);
+        if (it == ids.end()) return false;
+        id = it->second;
+        return true;
+    }
+    const string& name(uint32_t id) const { return names[id]; } // id -> name
+    size_t size() const { return names.size(); } // number of people
+private:
+    string key; // scratch for intern(data, length)
+};
+//===================================================== PART 4 : MAPPED LEDGER FILES =============================================
+// streams a transaction file straight into net balances: no Transaction objects, no per-row allocation
+// the file is mmapped read-only; pages already parsed are dropped every WINDOW bytes,
+// so memory stays constant apart from the interner and the balance table
+// formats:
+//   CSV    : "from,to,amount" per line; amount is an integer or decimal ("12.50"),
+//            stored in units of 10^-scale (scale 2 -> cents); a non-numeric first row
+//            (after any comments) is taken as a header; empty lines and lines starting with '#' are skipped
+//   binary : "RTXB", uint32 version (1), uint32 name count, names as {uint16 length, bytes},
+//            then records {uint32 from, uint32 to, int64 amount} (little endian) up to EOF
+class LedgerFileReader {
+private:
+    static const size_t WINDOW = 64 << 20; // release parsed pages every 64 MB
+    const char* data = nullptr; // mapped file
+    size_t length = 0; // file size
+    size_t released = 0; // bytes already given back to the kernel
+    // maps the whole file read-only, sequential access hint
+    void map(const string& path) {
+        int fd = open(path.c_str(), O_RDONLY); // open file
+        if (fd < 0) throw runtime_error("cannot open " + path);
+        struct stat info;
+        if (fstat(fd, &info) != 0) { close(fd); throw runtime_error("cannot stat " + path); }
+        length = info.st_size; // file size
+        if (length > 0) {
+            void* mapped = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0); // zero-copy view
+            if (mapped == MAP_FAILED) { close(fd); throw runtime_error("cannot map " + path); }
+            madvise(mapped, length, MADV_SEQUENTIAL); // aggressive read-ahead
+            data = (const char*)mapped;
+        }
+        close(fd); // mapping stays valid
+    }
+    // drops parsed pages once a full window is behind the cursor
+    void release(size_t pos) {
+        if (pos - released < WINDOW) return; // not yet
+        size_t upto = pos & ~(size_t)(sysconf(_SC_PAGESIZE) - 1); // page aligned
+        madvise((void*)(data + released), upto - released, MADV_DONTNEED); // give pages back
+        released = upto;
+    }
+    // decimal "[-]digits[.digits]" -> integer in units of 10^-scale; false if malformed or beyond +-LLONG_MAX units
+    static bool parseAmount(const char* p, const char* end, int scale, long long& amount) {
+        bool negative = p < end && *p == '-'; // sign
+        if (negative || (p < end && *p == '+')) p++;
+        if (p == end) return false; // no digits
+        long long value = 0; // accumulated units
+        auto shift = [&](int digit) { // value = value * 10 + digit; false on overflow
+            if (value > (LLONG_MAX - digit) / 10) return false;
+            value = value * 10 + digit;
+            return true;
+        };
+        bool digits = false; // saw at least one digit
+        for (; p < end && *p >= '0' && *p <= '9'; p++, digits = true) {
+            if (!shift(*p - '0')) return false; // integer part too large
+        }
+        int fraction = 0; // fractional digits consumed
+        if (p < end && *p == '.') {
+            for (p++; p < end && *p >= '0' && *p <= '9'; p++, digits = true) {
+                if (fraction == scale) { if (*p != '0') return false; continue; } // finer than the unit
+                if (!shift(*p - '0')) return false;
+                fraction++;
+            }
+        }
+        if (!digits || p != end) return false; // junk in the field
+        for (; fraction < scale; fraction++) {
+            if (!shift(0)) return false; // pad to the unit
+        }
+        amount = negative ? -value : value;
+        return true;
+    }
+    // trims spaces around a field
+    static void trim(const char*& begin, const char*& end) {
+        while (begin < end && (*begin == ' ' || *begin == '\t')) begin++;
+        while (end > begin && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r')) end--;
+    }
+public:
+    LedgerFileReader(const string& path) { map(path); } // maps the file
+    ~LedgerFileReader() { if (data) munmap((void*)data, length); } // unmap
+    LedgerFileReader(const LedgerFileReader&) = delete; // owns the mapping
+    LedgerFileReader& operator=(const LedgerFileReader&) = delete;
+    // binary files start with "RTXB", everything else is CSV
+    bool isBinary() const { return length >= 4 && memcmp(data, "RTXB", 4) == 0; }
+    // adds every row to balance (indexed by people ids); returns number of rows
+    // Time: O(file size)
+    size_t accumulate(NameInterner& people, vector<long long>& balance, int scale = 0) {
+        return isBinary() ? accumulateBinary(people, balance) : accumulateCsv(people, balance, scale);
+    }
+    size_t accumulateCsv(NameInterner& people, vector<long long>& balance, int scale) {
+        size_t rows = 0, line = 0; // counters
+        bool first = true; // next row is the first one that is not blank or a comment
+        for (size_t pos = 0; pos < length; ) {
+            const char* begin = data + pos; // line start
+            const char* newline = (const char*)memchr(begin, '\n', length - pos); // line end
+            const char* end = newline ? newline : data + length;
+            pos = end - data + 1; // next line
+            line++;
+            const char* lineEnd = end;
+            trim(begin, lineEnd);
+            if (begin == lineEnd || *begin == '#') continue; // blank or comment
+            bool header = first; // only the first real row may be a header
+            first = false;
+            const char* comma1 = (const char*)memchr(begin, ',', lineEnd - begin); // after payer
+            const char* comma2 = comma1 ? (const char*)memchr(comma1 + 1, ',', lineEnd - comma1 - 1) : nullptr; // after receiver
+            if (!comma2) throw runtime_error("line " + to_string(line) + ": expected from,to,amount");
+            const char *fromBegin = begin, *fromEnd = comma1; // payer field
+            const char *toBegin = comma1 + 1, *toEnd = comma2; // receiver field
+            const char *amountBegin = comma2 + 1, *amountEnd = lineEnd; // amount field
+            trim(fromBegin, fromEnd);
+            trim(toBegin, toEnd);
+            trim(amountBegin, amountEnd);
+            long long amount;
+            if (!parseAmount(amountBegin, amountEnd, scale, amount)) {
+                bool numeric = amountBegin < amountEnd && strchr("+-.0123456789", *amountBegin); // an amount, just a bad one
+                if (header && !numeric) continue; // header row
+                throw runtime_error("line " + to_string(line) + ": bad amount");
+            }
+            uint32_t from = people.intern(fromBegin, fromEnd - fromBegin); // payer id
+            uint32_t to = people.intern(toBegin, toEnd - toBegin); // receiver id
+            if (balance.size() < people.size()) balance.resize(people.size(), 0); // grow with new people
+            balance[from] -= amount; // payer loses money
+            balance[to] += amount; // receiver gains money
+            rows++;
+            release(pos < length ? pos : length);
+        }
+        return rows;
+    }
+    size_t accumulateBinary(NameInterner& people, vector<long long>& balance) {
+        auto read = [&](size_t& pos, void* out, size_t bytes) { // bounds-checked copy (fields are unaligned)
+            if (length - pos < bytes) throw runtime_error("truncated ledger file");
+            memcpy(out, data + pos, bytes);
+            pos += bytes;
+        };
+        size_t pos = 4; // after magic
+        uint32_t version, count;
+        read(pos, &version, 4);
+        if (version != 1) throw runtime_error("unsupported ledger version " + to_string(version));
+        read(pos, &count, 4);
+        if (count > (length - pos) / 2) throw runtime_error("truncated ledger file"); // each name needs its uint16 length
+        vector<uint32_t> ids(count); // file id -> interned id
+        for (uint32_t i = 0; i < count; i++) {
+            uint16_t nameLength;
+            read(pos, &nameLength, 2);
+            if (length - pos < nameLength) throw runtime_error("truncated ledger file");
+            ids[i] = people.intern(data + pos, nameLength); // names are interned once
+            pos += nameLength;
+        }
+        if (balance.size() < people.size()) balance.resize(people.size(), 0);
+        const size_t RECORD = 16; // uint32 + uint32 + int64
+        if ((length - pos) % RECORD != 0) throw runtime_error("truncated ledger file");
+        size_t rows = 0;
+        while (pos < length) {
+            uint32_t from, to;
+            int64_t amount;
+            read(pos, &from, 4);
+            read(pos, &to, 4);
+            read(pos, &amount, 8);
+            if (from >= count || to >= count) throw runtime_error("record " + to_string(rows) + ": unknown person");
+            balance[ids[from]] -= amount; // payer loses money
+            balance[ids[to]] += amount; // receiver gains money
+            rows++;
+            release(pos);
+        }
+        return rows;
+    }
+};
 //===================================================== PART 1 : SETTLEMENT ENGINE ===============================================
 class SettlementService {
 private:
@@ -34,6 +246,13 @@ private:
         }
         return balance; // return net balances
     }
+    // runs body(0..shards-1), one thread per shard (shard 0 on the caller)
+    static void runShards(int shards, const function<void(int)>& body) {
+        vector<thread> workers; // shards 1..n-1
+        for (int s = 1; s < shards; s++) workers.emplace_back(body, s);
+        body(0); // caller takes shard 0
+        for (auto &w : workers) w.join(); // wait for all shards
+    }
 public:
 //===================================================== PART 1 : BASIC SETTLEMENT (NOT OPTIMAL) =================================
 // settle balances in simple way (not minimum transactions)
@@ -90,9 +309,254 @@ public:
         }
         return result; // return optimized settlements
     }
+//===================================================== PART 5 : INTERNED SETTLEMENT ============================================
+// net balance per dense id; names are interned once per transaction
+// Time: O(T)
+    vector<long long> computeNetBalanceDense(vector<Transaction>& transactions, NameInterner& people) {
+        vector<long long> balance; // id -> net balance
+        for (auto &t : transactions) {
+            uint32_t from = people.intern(t.from); // payer id
+            uint32_t to = people.intern(t.to); // receiver id
+            if (balance.size() < people.size()) balance.resize(people.size(), 0); // grow with new people
+            balance[from] -= t.amount; // payer loses money
+            balance[to] += t.amount; // receiver gains money
+        }
+        return balance;
+    }
+// same greedy as settleOptimal, but on (amount, id) pairs in flat heaps: no strings touched
+// heaps are built with make_heap in O(N) instead of N pushes
+// Time: O(N log N)
+    vector<tuple<uint32_t,uint32_t,long long>> settleOptimalIds(const vector<long long>& balance) {
+        vector<pair<long long,uint32_t>> maxCredit, maxDebit; // flat heap storage
+        for (uint32_t id = 0; id < balance.size(); id++) {
+            if (balance[id] > 0) maxCredit.push_back({balance[id], id}); // creditor
+            else if (balance[id] < 0) maxDebit.push_back({-balance[id], id}); // debtor
+        }
+        make_heap(maxCredit.begin(), maxCredit.end()); // O(N) heapify
+        make_heap(maxDebit.begin(), maxDebit.end());
+        return settleHeaps(maxCredit, maxDebit);
+    }
+// greedy core: repeatedly settles the largest creditor against the largest debtor
+// maxCredit / maxDebit must be max-heaps of {amount, id} (a descending array is one); both are consumed
+// Time: O(N log N)
+    static vector<tuple<uint32_t,uint32_t,long long>> settleHeaps(vector<pair<long long,uint32_t>>& maxCredit,
+                                                                   vector<pair<long long,uint32_t>>& maxDebit) {
+        vector<tuple<uint32_t,uint32_t,long long>> result; // {debtor, creditor, amount}
+        result.reserve(max(maxCredit.size(), maxDebit.size())); // at most creditors + debtors - 1 rows
+        while (!maxCredit.empty() && !maxDebit.empty()) {
+            pop_heap(maxCredit.begin(), maxCredit.end()); // max creditor to back
+            pop_heap(maxDebit.begin(), maxDebit.end()); // max debtor to back
+            auto [credit, creditor] = maxCredit.back();
+            auto [debit, debtor] = maxDebit.back();
+            long long settleAmount = min(credit, debit); // settle max possible
+            result.push_back({debtor, creditor, settleAmount}); // record transaction
+            if (credit > settleAmount) { // remaining credit goes back in place
+                maxCredit.back().first = credit - settleAmount;
+                push_heap(maxCredit.begin(), maxCredit.end());
+            } else maxCredit.pop_back();
+            if (debit > settleAmount) { // remaining debt goes back in place
+                maxDebit.back().first = debit - settleAmount;
+                push_heap(maxDebit.begin(), maxDebit.end());
+            } else maxDebit.pop_back();
+        }
+        return result;
+    }
+//===================================================== PART 6 : SHARDED AGGREGATION ===========================================
+// each worker interns and sums its own contiguous shard, so nothing is shared while scanning
+// merge: shard names are split by hash into one partition per worker; each partition finds,
+// for its names, the first (shard, local id) holding them. Global ids go to those first
+// occurrences shard by shard in local order, which is exactly the serial first-appearance
+// order -> same ids as computeNetBalanceDense. Only the N distinct names are then interned
+// into `people` on one thread; each worker sums one stripe of global ids over all shards, in shard order
+// sums are integers, so balances are bit-identical to the serial loop
+// Time: O(T / threads + D log D / threads + N), D = distinct people summed over shards
+    vector<long long> computeNetBalanceSharded(vector<Transaction>& transactions, NameInterner& people, int threads) {
+        const size_t MIN_SHARD = 1 << 14; // smaller shards are not worth a thread
+        size_t count = transactions.size();
+        int shards = max<size_t>(1, min<size_t>(max(1, threads), count / MIN_SHARD)); // worker count
+        if (shards == 1) return computeNetBalanceDense(transactions, people); // serial path
+        struct Shard {
+            NameInterner names; // shard-local ids
+            vector<long long> balance; // local id -> net delta
+            vector<uint32_t> globalId; // local id -> global id
+            vector<vector<uint32_t>> byPartition; // local ids, split by name hash
+            vector<pair<int,uint32_t>> firstSeen; // local id -> (shard, local id) of the name's first appearance
+            uint32_t firstCount = 0; // names appearing here before any earlier shard
+            vector<pair<uint32_t,long long>> deltas; // {global id, delta} sorted by global id
+        };
+        vector<Shard> local(shards); // one per worker
+        runShards(shards, [&](int s) { // scan: thread-local interning + dense sums
+            Shard& shard = local[s];
+            for (size_t i = count * s / shards; i < count * (s + 1) / shards; i++) {
+                auto &t = transactions[i];
+                uint32_t from = shard.names.intern(t.from); // local payer id
+                uint32_t to = shard.names.intern(t.to); // local receiver id
+                if (shard.balance.size() < shard.names.size()) shard.balance.resize(shard.names.size(), 0);
+                shard.balance[from] -= t.amount; // payer loses money
+                shard.balance[to] += t.amount; // receiver gains money
+            }
+        });
+        runShards(shards, [&](int s) { // split local names by hash
+            Shard& shard = local[s];
+            shard.byPartition.resize(shards);
+            shard.firstSeen.resize(shard.names.size());
+            for (uint32_t id = 0; id < shard.names.size(); id++)
+                shard.byPartition[hash<string>()(shard.names.name(id)) % shards].push_back(id);
+        });
+        runShards(shards, [&](int p) { // per partition: first appearance of each name, shards in order
+            unordered_map<string_view, pair<int,uint32_t>> first; // name -> (shard, local id)
+            for (int s = 0; s < shards; s++) {
+                for (uint32_t id : local[s].byPartition[p]) {
+                    auto it = first.emplace(local[s].names.name(id), make_pair(s, id)).first; // keeps the earliest
+                    local[s].firstSeen[id] = it->second; // each local id belongs to exactly one partition
+                }
+            }
+        });
+        runShards(shards, [&](int s) { // count first appearances per shard
+            Shard& shard = local[s];
+            for (uint32_t id = 0; id < shard.names.size(); id++) shard.firstCount += shard.firstSeen[id].first == s;
+        });
+        vector<uint32_t> firstBase(shards + 1, 0); // global ids of shard s start at firstBase[s]
+        for (int s = 0; s < shards; s++) firstBase[s + 1] = firstBase[s] + local[s].firstCount;
+        runShards(shards, [&](int s) { // first appearances: global ids in serial first-appearance order
+            Shard& shard = local[s];
+            shard.globalId.resize(shard.names.size());
+            uint32_t next = firstBase[s];
+            for (uint32_t id = 0; id < shard.names.size(); id++) if (shard.firstSeen[id].first == s) shard.globalId[id] = next++;
+        });
+        runShards(shards, [&](int s) { // repeats: global id of the first appearance
+            Shard& shard = local[s];
+            for (uint32_t id = 0; id < shard.names.size(); id++) {
+                auto [owner, ownerId] = shard.firstSeen[id];
+                if (owner != s) shard.globalId[id] = local[owner].globalId[ownerId];
+            }
+        });
+        vector<uint32_t> interned(firstBase[shards]); // global id -> id in people (the same when people starts empty)
+        for (int s = 0; s < shards; s++) { // N distinct names, in global id order
+            Shard& shard = local[s];
+            for (uint32_t id = 0; id < shard.names.size(); id++)
+                if (shard.firstSeen[id].first == s) interned[shard.globalId[id]] = people.intern(shard.names.name(id));
+        }
+        runShards(shards, [&](int s) { // per shard: deltas sorted by global id
+            Shard& shard = local[s];
+            for (uint32_t id = 0; id < shard.balance.size(); id++) shard.deltas.push_back({interned[shard.globalId[id]], shard.balance[id]});
+            sort(shard.deltas.begin(), shard.deltas.end());
+        });
+        vector<long long> balance(people.size(), 0); // global id -> net balance
+        runShards(shards, [&](int s) { // merge: stripe of global ids, shards in order
+            uint32_t lo = (uint64_t)balance.size() * s / shards, hi = (uint64_t)balance.size() * (s + 1) / shards;
+            for (auto &shard : local) {
+                auto it = lower_bound(shard.deltas.begin(), shard.deltas.end(), make_pair(lo, LLONG_MIN)); // stripe start
+                for (; it != shard.deltas.end() && it->first < hi; ++it) balance[it->first] += it->second;
+            }
+        });
+        return balance;
+    }
+// interned version of settleOptimal: names are resolved only when emitting the result
+// threads > 1 aggregates balances with computeNetBalanceSharded (same plan as threads = 1)
+// Time: O(T / threads + N log N)
+    vector<tuple<string,string,long long>> settleOptimalInterned(vector<Transaction>& transactions, int threads = 1) {
+        NameInterner people; // name <-> id
+        auto balance = computeNetBalanceSharded(transactions, people, threads); // flat balances
+        vector<tuple<string,string,long long>> result;
+        for (auto &[debtor, creditor, amount] : settleOptimalIds(balance))
+            result.push_back({people.name(debtor), people.name(creditor), amount}); // resolve names
+        return result;
+    }
+// settles a CSV / binary ledger file without materializing transactions (see LedgerFileReader)
+// amounts in the result are in units of 10^-scale
+// Time: O(file size + N log N)
+    vector<tuple<string,string,long long>> settleOptimalFromFile(const string& path, int scale = 0) {
+        NameInterner people; // name <-> id
+        vector<long long> balance; // flat balances
+        LedgerFileReader(path).accumulate(people, balance, scale); // stream rows into balances
+        vector<tuple<string,string,long long>> result;
+        for (auto &[debtor, creditor, amount] : settleOptimalIds(balance))
+            result.push_back({people.name(debtor), people.name(creditor), amount}); // resolve names
+        return result;
+    }
+};
+//===================================================== PART 7 : ONLINE SETTLEMENT LEDGER =======================================
+// changes between two published plans, so only the affected people are notified
+struct PlanDelta {
+    vector<tuple<string,string,long long>> added; // payments that are new or changed amount
+    vector<tuple<string,string,long long>> removed; // payments that disappeared or changed amount
+    vector<string> affected; // everyone paying or receiving in added / removed
+};
+// keeps net balances and ordered creditor / debtor indexes live, one event at a time
+// plan() runs the settleOptimal greedy over the indexes only (no history is kept or rescanned)
+// and gives exactly settleOptimalIds of the current balances
+// removeTransaction must mirror an earlier addTransaction; the ledger cannot check that
+class SettlementLedger {
+private:
+    NameInterner people; // name <-> id
+    vector<long long> balance; // id -> net balance
+    set<pair<long long,uint32_t>> creditors; // {credit, id}, balance > 0
+    set<pair<long long,uint32_t>> debtors; // {debt, id}, balance < 0
+    vector<tuple<uint32_t,uint32_t,long long>> published; // last published plan, sorted
+    // moves one person to its new balance in the indexes
+    // Time: O(log N)
+    void adjust(uint32_t id, long long change) {
+        if (balance[id] > 0) creditors.erase({balance[id], id}); // leave old position
+        else if (balance[id] < 0) debtors.erase({-balance[id], id});
+        balance[id] += change; // new balance
+        if (balance[id] > 0) creditors.insert({balance[id], id}); // enter new position
+        else if (balance[id] < 0) debtors.insert({-balance[id], id});
+    }
+    void apply(const string& from, const string& to, long long amount) {
+        uint32_t payer = people.intern(from); // payer id
+        uint32_t receiver = people.intern(to); // receiver id
+        if (balance.size() < people.size()) balance.resize(people.size(), 0); // grow with new people
+        adjust(payer, -amount); // payer loses money
+        adjust(receiver, amount); // receiver gains money
+    }
+    vector<tuple<string,string,long long>> resolve(const vector<tuple<uint32_t,uint32_t,long long>>& plan) const {
+        vector<tuple<string,string,long long>> result;
+        for (auto &[debtor, creditor, amount] : plan)
+            result.push_back({people.name(debtor), people.name(creditor), amount}); // resolve names
+        return result;
+    }
+public:
+    // Time: O(log N)
+    void addTransaction(const Transaction& t) { apply(t.from, t.to, t.amount); }
+    // Time: O(log N)
+    void removeTransaction(const Transaction& t) { apply(t.from, t.to, -t.amount); }
+    // current net balance of a person (0 if unknown)
+    long long balanceOf(const string& name) const {
+        uint32_t id;
+        if (!people.find(name, id)) return 0; // unknown: never paid or received, and a read adds no one
+        return id < balance.size() ? balance[id] : 0;
+    }
+    // current settlement plan {debtor, creditor, amount}, ids only
+    // Time: O(K log K), K = people with non-zero balance
+    vector<tuple<uint32_t,uint32_t,long long>> planIds() const {
+        vector<pair<long long,uint32_t>> maxCredit(creditors.rbegin(), creditors.rend()); // descending = valid max-heap
+        vector<pair<long long,uint32_t>> maxDebit(debtors.rbegin(), debtors.rend());
+        return SettlementService::settleHeaps(maxCredit, maxDebit);
+    }
+    // current settlement plan with names
+    vector<tuple<string,string,long long>> plan() const { return resolve(planIds()); }
+    // computes the current plan, makes it the published one and returns what changed
+    // Time: O(K log K)
+    PlanDelta publish() {
+        auto current = planIds();
+        sort(current.begin(), current.end()); // canonical order for diffing
+        vector<tuple<uint32_t,uint32_t,long long>> added, removed;
+        set_difference(current.begin(), current.end(), published.begin(), published.end(), back_inserter(added));
+        set_difference(published.begin(), published.end(), current.begin(), current.end(), back_inserter(removed));
+        set<uint32_t> affected; // people to notify
+        for (auto &rows : {added, removed})
+            for (auto &[debtor, creditor, amount] : rows) { affected.insert(debtor); affected.insert(creditor); }
+        PlanDelta delta;
+        delta.added = resolve(added);
+        delta.removed = resolve(removed);
+        for (uint32_t id : affected) delta.affected.push_back(people.name(id));
+        published = move(current); // becomes the baseline
+        return delta;
+    }
 };
 //===================================================== DEMO =====================================================================
-int main() { // program entry point
+int main(int argc, char** argv) { // program entry point
     vector<Transaction> transactions; // transaction list
     transactions.push_back(Transaction("A","B",100)); // A paid B
     transactions.push_back(Transaction("B","C",50)); // B paid C
@@ -108,5 +572,28 @@ int main() { // program entry point
     auto optimal = service.settleOptimal(transactions); // compute optimal settlement
     for (auto &t : optimal) // print
         cout << get<0>(t) << " pays " << get<1>(t) << " : " << get<2>(t) << "\n";
+    //=========================== PART 5 DEMO =====================================
+    cout << "\n----- Interned Settlement -----\n"; // header
+    auto interned = service.settleOptimalInterned(transactions); // same plan shape, no string heaps
+    for (auto &t : interned) // print
+        cout << get<0>(t) << " pays " << get<1>(t) << " : " << get<2>(t) << "\n";
+    //=========================== PART 4 DEMO =====================================
+    if (argc > 1) { // optional ledger file: ./a.out ledger.csv [scale]
+        cout << "\n----- Ledger File Settlement -----\n"; // header
+        auto fromFile = service.settleOptimalFromFile(argv[1], argc > 2 ? atoi(argv[2]) : 0); // stream file
+        for (auto &t : fromFile) // print
+            cout << get<0>(t) << " pays " << get<1>(t) << " : " << get<2>(t) << "\n";
+    }
+    //=========================== PART 7 DEMO =====================================
+    cout << "\n----- Online Ledger -----\n"; // header
+    SettlementLedger ledger; // live balances
+    for (auto &t : transactions) ledger.addTransaction(t); // replay events
+    ledger.publish(); // first plan
+    ledger.addTransaction(Transaction("D","C",20)); // new expense
+    PlanDelta delta = ledger.publish(); // only the changes
+    for (auto &t : delta.removed) // print
+        cout << "cancel: " << get<0>(t) << " pays " << get<1>(t) << " : " << get<2>(t) << "\n";
+    for (auto &t : delta.added) // print
+        cout << "new   : " << get<0>(t) << " pays " << get<1>(t) << " : " << get<2>(t) << "\n";
     return 0; // exit
 }